@@ -22,6 +22,10 @@ def readInputs(inputFiles):
           lines.append(line)
   return lines, layer, names
 
+# borrowed string/bytes views are serialized as the types they view
+def viewBaseName(name):
+  return re.sub(r'^(string|bytes)_view$', r'\1', name)
+
 # text serialization: types and funcs
 def addTextSerialize(typeList, typeData, typesDict, idPrefix, primeType, boxed, prefix):
   result = ''
@@ -72,7 +76,7 @@ def addTextSerialize(typeList, typeData, typesDict, idPrefix, primeType, boxed,
                 result += idPrefix + 'vector'
               else:
                 result += '0'
-              restype = vtypeget.group(1)
+              restype = viewBaseName(vtypeget.group(1))
               try:
                 if boxed[restype]:
                   restype = 0
@@ -80,7 +84,7 @@ def addTextSerialize(typeList, typeData, typesDict, idPrefix, primeType, boxed,
                 if re.match(r'^[A-Z]', restype):
                   restype = 0
             else:
-              restype = v
+              restype = viewBaseName(v)
               try:
                 if boxed[restype]:
                   restype = 0
@@ -223,6 +227,22 @@ def readAndGenerate(inputFiles, outputPath, scheme):
   builtinTemplateTypes = scheme.get('builtinTemplates', [])
   builtinInclude = scheme.get('builtinInclude', '')
   nullableTypes = scheme.get('nullable', [])
+  refcount = scheme.get('refcount', 'atomic')
+  if not refcount in ['atomic', 'local']:
+    print('Bad refcount policy: ' + refcount)
+    sys.exit(1)
+  localCounting = (refcount == 'local')
+  ownerClass = 'tl::details::local_type_owner' if localCounting else 'tl::details::type_owner'
+  viewFields = scheme.get('views', [])
+  pooledTypes = scheme.get('pooled', [])
+  compactTypes = scheme.get('compactTypes', [])
+  sparseConstructors = scheme.get('sparse', [])
+  cachedLength = scheme.get('cachedLength', False)
+  memoizedTypes = scheme.get('memoized', [])
+  lazyFieldNames = scheme.get('lazy', [])
+  lazyMinBytes = scheme.get('lazyMinBytes', 0)
+  frozen = scheme.get('frozen', False)
+  streaming = scheme.get('streaming', False)
   synonyms = scheme.get('synonyms', {})
   writeSections = scheme.get('sections', [])
   readWriteSection = 'read-write' in writeSections
@@ -232,6 +252,24 @@ def readAndGenerate(inputFiles, outputPath, scheme):
   primeType = primitiveTypeNames.get('prime', '')
   bufferType = primitiveTypeNames.get('buffer', '')
 
+  # additional Writer<> accumulators, like ::tl::gzip_buffer, are opted in by the scheme
+  accumulatorTypes = [bufferType, '::tl::details::LengthCounter', '::tl::details::SpanAccumulator']
+  accumulatorTypes += scheme.get('accumulators', [])
+  def writeInstantiations(className):
+    result = ''
+    for accumulator in accumulatorTypes:
+      result += 'template void ' + className + '::write<' + accumulator + '>(' + accumulator + ' &to) const;\n'
+    return result
+
+  # additional Reader<> primes, like std::byte for unaligned buffers
+  readerTypes = [primeType]
+  readerTypes += scheme.get('readers', [])
+  def readInstantiations(methodName, params):
+    result = ''
+    for prime in readerTypes:
+      result += 'template bool ' + methodName + '<' + prime + '>(const ' + prime + ' *&from, const ' + prime + ' *end' + params + ');\n'
+    return result
+
   writeConversion = 'conversion' in scheme
   conversionScheme = scheme.get('conversion', {})
   conversionInclude = conversionScheme.get('include') if writeConversion else ''
@@ -257,10 +295,140 @@ def readAndGenerate(inputFiles, outputPath, scheme):
     if readWriteSection or writeSerialization:
       print('Required types not provided.')
       sys.exit(1)
+  if streaming and not readWriteSection:
+    print('Streaming requires the read-write section.')
+    sys.exit(1)
 
   def isBuiltinType(name):
     return name in builtinTypes or name in builtinTemplateTypes
 
+  # parameters of other types are taken by value and moved from,
+  # so that whole trees can be built without copies
+  def isScalarParam(name):
+    return name in ['int', 'Int', 'bool', 'Bool'] or name.startswith('flags<')
+  def sinkParam(type, name):
+    return name if isScalarParam(type) else 'std::move(' + name + ')'
+
+  # constructors of only these are read and written as a single block,
+  # see tl::details::read_fixed() and tl::details::write_fixed()
+  def fixedLayoutFields(prmsList, prms, hasFlags, trivialConditions):
+    fields = [paramName for paramName in prmsList if not paramName in trivialConditions]
+    if hasFlags != '' or len(fields) < 2:
+      return []
+    for paramName in fields:
+      if not isFixedWidth(prms[paramName]):
+        return []
+    return fields
+  def isFixedWidth(type):
+    return type in ['int', 'long', 'int128', 'int256', 'double']
+  def fixedLayoutPrimes(fields, prms):
+    return 'tl::details::kFixedLayoutPrimes<' + ', '.join(fullTypeName(prms[paramName]) for paramName in fields) + '>'
+
+  def reindentLines(text, fromTabs, toTabs):
+    return ''.join(('\t' * toTabs) + line[fromTabs:] + '\n' for line in text.splitlines())
+
+  # builtin scalars and flags never own type_data
+  def mayHoldData(name):
+    return not (name in builtinTypes or name.startswith('flags<'))
+
+  # 'pooled' lists '*', boxed type or constructor names whose data objects
+  # are allocated from thread-local pools, see tl/tl_pool.h.
+  def isPooledData(type, constructor):
+    boxedName = type[:1].upper() + type[1:]
+    return ('*' in pooledTypes) or (boxedName in pooledTypes) or (constructor in pooledTypes)
+
+  # 'compactTypes' lists '*' or boxed type names whose handles keep
+  # the constructor index in the data object instead of a type id field.
+  def isCompactType(type):
+    boxedName = type[:1].upper() + type[1:]
+    return ('*' in compactTypes) or (boxedName in compactTypes)
+
+  # 'memoized' lists '*', boxed type or constructor names whose data objects
+  # may keep their encoded fields, see tl/tl_memoize.h.
+  def isMemoizedData(type, constructor):
+    boxedName = type[:1].upper() + type[1:]
+    return ('*' in memoizedTypes) or (boxedName in memoizedTypes) or (constructor in memoizedTypes)
+
+  # 'sparse' lists '*' or constructor names whose flag-conditional fields
+  # are kept in a tl::details::sparse_storage block, see tl/tl_sparse.h.
+  def isSparseData(constructor):
+    return ('*' in sparseConstructors) or (constructor in sparseConstructors)
+
+  # 'views' lists '*', constructor names or 'constructor.field' entries
+  # whose string / bytes fields should borrow from the input buffer.
+  def isViewField(constructor, field):
+    return ('*' in viewFields) or (constructor in viewFields) or ((constructor + '.' + field) in viewFields)
+
+  # 'lazy' lists '*', constructor names or 'constructor.field' entries
+  # whose fields are decoded on first access, see tl/tl_lazy.h.
+  # With 'lazyMinBytes' smaller encoded values are decoded right away.
+  def isLazyField(constructor, field, type):
+    if isFixedWidth(type) or type.startswith('flags<'):
+      return False
+    return ('*' in lazyFieldNames) or (constructor in lazyFieldNames) or ((constructor + '.' + field) in lazyFieldNames)
+  def lazyTypeName(type):
+    return 'tl::details::lazy<' + fullTypeName(type) + ', ' + primeType + (', ' + str(lazyMinBytes) if lazyMinBytes else '') + '>'
+
+  # 'streaming' describes the wire layout of every constructor
+  # as a program of ops, see tl/tl_stream.h.
+  def streamItem(type):
+    fixed = {'int': 1, 'long': 2, 'double': 2, 'int128': 4, 'int256': 8}
+    boxedFixed = {'Int': 1, 'Long': 2, 'Double': 2}
+    vector = re.match(r'^([vV])ector<' + typePrefix + r'(.+)>$', type)
+    if type in fixed:
+      return [('primes', fixed[type])]
+    elif type in boxedFixed:
+      return [('primes', 1 + boxedFixed[type])]
+    elif type in ['string', 'bytes', 'string_view', 'bytes_view']:
+      return [('string',)]
+    elif vector:
+      item = streamItem(vector.group(2))
+      return [('boxed_vector' if vector.group(1) == 'V' else 'vector', len(item))] + item
+    elif type in streamTypeIndex and len(typesDict[type]) == 1:
+      return [('bare', streamTypeIndex[type])]
+    elif type in streamBoxedIndex:
+      return [('boxed', streamBoxedIndex[type])]
+    print('Type "' + type + '" can\'t be streamed.')
+    sys.exit(1)
+  def streamProgram(prmsList, prms, hasFlags, conditions, trivialConditions):
+    result = []
+    merge = False
+    for paramName in prmsList:
+      if paramName in trivialConditions:
+        continue
+      elif paramName == hasFlags:
+        result.append(('flags',))
+        merge = False
+        continue
+      item = streamItem(prms[paramName])
+      if paramName in conditions:
+        result.append(('conditional', conditions[paramName], len(item)))
+        result += item
+        merge = False
+      elif item[0][0] == 'primes' and merge:
+        result[-1] = ('primes', result[-1][1] + item[0][1])
+      else:
+        result += item
+        merge = (item[0][0] == 'primes')
+    result.append(('end',))
+    return ['tl::details::stream_' + op[0] + '(' + ', '.join(str(arg) for arg in op[1:]) + ')' for op in result]
+
+  def viewTypeName(name):
+    viewed = ''
+    vector = re.match(r'^([vV]ector<)' + typePrefix + r'(string|bytes)>$', name)
+    if name in ['string', 'bytes']:
+      viewed = name + '_view'
+      result = viewed
+    elif vector:
+      viewed = vector.group(2) + '_view'
+      result = vector.group(1) + fullTypeName(viewed) + '>'
+    else:
+      return name
+    if not viewed in builtinTypes:
+      print('View type "' + viewed + '" should be declared in builtin types.')
+      sys.exit(1)
+    return result
+
   funcs = 0
   types = 0
   consts = 0
@@ -276,6 +444,7 @@ def readAndGenerate(inputFiles, outputPath, scheme):
   funcsText = ''
   typesText = ''
   dataTexts = ''
+  frozenTexts = ''
   creatorProxyText = ''
   factories = ''
   flagOperators = ''
@@ -446,6 +615,8 @@ def readAndGenerate(inputFiles, outputPath, scheme):
         elif (ptype.find('<') >= 0):
           ptype = handleTemplate(ptype)
       prmsList.append(pname)
+      if isViewField(originalname, pname):
+        ptype = viewTypeName(ptype)
       normalizedType = normalizedName(ptype)
       if (normalizedType in TypeConstructors):
         prms[pname] = TypeConstructors[normalizedType]['typeBare']
@@ -488,16 +659,13 @@ def readAndGenerate(inputFiles, outputPath, scheme):
           if (paramName in trivialConditions):
             continue
           paramType = prms[paramName]
-          prmsInit.append('_' + paramName + '(' + paramName + '_)')
+          prmsInit.append('_' + paramName + '(' + sinkParam(paramType, paramName + '_') + ')')
           prmsNames.append(paramName + '_')
           if (paramName == isTemplate):
             ptypeFull = paramType
           else:
             ptypeFull = fullTypeName(paramType)
-          if (paramType in ['int', 'Int', 'bool', 'Bool', 'flags<Flags>']):
-            prmsStr.append(ptypeFull + ' ' + paramName + '_')
-          else:
-            prmsStr.append('const ' + ptypeFull + ' &' + paramName + '_')
+          prmsStr.append(ptypeFull + ' ' + paramName + '_')
 
       funcsText += '\t' + fullTypeName(name) + '();\n';# = default; # constructor
       if (isTemplate != ''):
@@ -515,6 +683,9 @@ def readAndGenerate(inputFiles, outputPath, scheme):
           methodBodies += fullTypeName(name) + '::' + fullTypeName(name) + '(' + ', '.join(prmsStr) + ') : ' + ', '.join(prmsInit) + ' {\n}\n'
 
       funcsText += '\t' + typeIdType + ' type() const {\n\t\treturn ' + idPrefix + name + ';\n\t}\n'; # type id
+      fixedFields = fixedLayoutFields(prmsList, prms, hasFlags, trivialConditions)
+      if fixedFields:
+        funcsText += '\n\tstatic constexpr uint32 kEncodedPrimes = ' + fixedLayoutPrimes(fixedFields, prms) + ';\n'
       if readWriteSection:
         funcsText += '\n'
         funcsText += '\ttemplate <typename Prime>\n'
@@ -534,13 +705,48 @@ def readAndGenerate(inputFiles, outputPath, scheme):
               readFunc += '\t\t&& ((_' + hasFlags + '.v & Flag::f_' + k + ') ? _' + k + '.read(from, end) : ((_' + k + ' = ' + fullTypeName(v) + '()), true))\n'
           else:
             readFunc += '\t\t&& _' + k + '.read(from, end)\n'
+        if fixedFields:
+          readFunc = '\t\t&& tl::details::read_fixed(from, end, ' + ', '.join('_' + k for k in fixedFields) + ')\n'
         if readFunc != '':
           methodBodies += '\treturn' + readFunc[4:len(readFunc)-1] + ';\n'
         else:
           methodBodies += '\treturn true;\n'
         methodBodies += '}\n'
         if isTemplate == '':
-          methodBodies += 'template bool ' + fullTypeName(name) + '::read<' + primeType + '>(const ' + primeType + ' *&from, const ' + primeType + ' *end, ' + typeIdType + ' cons);\n'
+          methodBodies += readInstantiations(fullTypeName(name) + '::read', ', ' + typeIdType + ' cons')
+
+        funcsText += '\ttemplate <typename Prime>\n'
+        funcsText += '\t[[nodiscard]] static bool skip(const Prime *&from, const Prime *end, ' + typeIdType + ' cons = 0, tl::skip_stats *stats = nullptr);\n'; # skip method
+        if (isTemplate != ''):
+          methodBodies += 'template <typename TQueryType>\n'
+          methodBodies += 'template <typename Prime>\n'
+          methodBodies += 'bool ' + fullTypeName(name) + '<TQueryType>::skip(const Prime *&from, const Prime *end, ' + typeIdType + ' cons, tl::skip_stats *stats) {\n'
+        else:
+          methodBodies += 'template <typename Prime>\n'
+          methodBodies += 'bool ' + fullTypeName(name) + '::skip(const Prime *&from, const Prime *end, ' + typeIdType + ' cons, tl::skip_stats *stats) {\n'
+        methodBodies += '\tif (cons && cons != ' + idPrefix + name + ') return false;\n'
+        methodBodies += '\tif (stats) ++stats->objects;\n'
+        skipFunc = ''
+        for k in prmsList:
+          v = prms[k]
+          if k == hasFlags:
+            skipFunc += '\t\t&& tl::details::skip_flags(from, end, flags)\n'
+          elif (k in conditionsList):
+            if (not k in trivialConditions):
+              skipFunc += '\t\t&& (!(flags & (1U << ' + conditions[k] + ')) || ' + ('TQueryType' if k == isTemplate else fullTypeName(v)) + '::skip(from, end, 0, stats))\n'
+          else:
+            skipFunc += '\t\t&& ' + ('TQueryType' if k == isTemplate else fullTypeName(v)) + '::skip(from, end, 0, stats)\n'
+        if fixedFields:
+          skipFunc = '\t\t&& tl::details::skip_primes(from, end, kEncodedPrimes)\n'
+        elif hasFlags != '':
+          methodBodies += '\tauto flags = uint32();\n'
+        if skipFunc != '':
+          methodBodies += '\treturn' + skipFunc[4:len(skipFunc)-1] + ';\n'
+        else:
+          methodBodies += '\treturn true;\n'
+        methodBodies += '}\n'
+        if isTemplate == '':
+          methodBodies += readInstantiations(fullTypeName(name) + '::skip', ', ' + typeIdType + ' cons, tl::skip_stats *stats')
 
         funcsText += '\ttemplate <typename Accumulator>\n'
         funcsText += '\tvoid write(Accumulator &to) const;\n'; # write method
@@ -551,7 +757,9 @@ def readAndGenerate(inputFiles, outputPath, scheme):
         else:
           methodBodies += 'template <typename Accumulator>\n'
           methodBodies += 'void ' + fullTypeName(name) + '::write(Accumulator &to) const {\n'
-        for k in prmsList:
+        if fixedFields:
+          methodBodies += '\ttl::details::write_fixed(to, ' + ', '.join('_' + k for k in fixedFields) + ');\n'
+        for k in ([] if fixedFields else prmsList):
           v = prms[k]
           if (k in conditionsList):
             if (not k in trivialConditions):
@@ -560,8 +768,19 @@ def readAndGenerate(inputFiles, outputPath, scheme):
             methodBodies += '\t_' + k + '.write(to);\n'
         methodBodies += '}\n'
         if isTemplate == '':
-          methodBodies += 'template void ' + fullTypeName(name) + '::write<' + bufferType + '>(' + bufferType + ' &to) const;\n'
-          methodBodies += 'template void ' + fullTypeName(name) + '::write<::tl::details::LengthCounter>(::tl::details::LengthCounter &to) const;\n'
+          methodBodies += writeInstantiations(fullTypeName(name))
+
+      if localCounting and len(prms) > len(trivialConditions):
+        funcsText += '\tvoid publish() const;\n'
+        if (isTemplate != ''):
+          methodBodies += 'template <typename TQueryType>\n'
+          methodBodies += 'void ' + fullTypeName(name) + '<TQueryType>::publish() const {\n'
+        else:
+          methodBodies += 'void ' + fullTypeName(name) + '::publish() const {\n'
+        for k in prmsList:
+          if (not k in trivialConditions) and mayHoldData(prms[k]):
+            methodBodies += '\ttl::publish(_' + k + ');\n'
+        methodBodies += '}\n'
 
       if writeConversion:
         conversionHeader += fullTypeName(name) + ' tl_from(' + conversionPointer(name) + ' &&value);\n'
@@ -665,6 +884,12 @@ def readAndGenerate(inputFiles, outputPath, scheme):
   textSerializeMethods += addTextSerialize(funcsList, funcsDict, typesDict, idPrefix, primeType, boxed, typePrefix)
   textSerializeInit += addTextSerializeInit(funcsList, funcsDict, idPrefix) + '\n'
 
+  streamTypeIndex = {restype: index for index, restype in enumerate(typesList)}
+  streamBoxedIndex = {TypesDict[restype]: index for index, restype in enumerate(typesList)}
+  streamOps = []
+  streamConstructors = []
+  streamTypes = []
+
   for restype in typesList:
     v = typesDict[restype]
     resType = TypesDict[restype]
@@ -680,12 +905,22 @@ def readAndGenerate(inputFiles, outputPath, scheme):
 
     withType = (len(v) > 1)
     nullable = restype in nullableTypes
+    compact = withType and isCompactType(restype) and any(len(data[3]) > len(data[7]) for data in v)
+    typeField = 'typeFromData()' if compact else '_type'
+    typeIndex = 0
     switchLines = ''
     friendDecl = ''
     getters = ''
     visitor = ''
     reader = ''
     writer = ''
+    publisher = ''
+    memoizer = ''
+    skipper = ''
+    freezer = ''
+    thawer = ''
+    frozenGetters = ''
+    frozenChecker = ''
     newFast = ''
 
     if writeConversion:
@@ -738,6 +973,7 @@ def readAndGenerate(inputFiles, outputPath, scheme):
       conditionsList = data[5]
       conditions = data[6]
       trivialConditions = data[7]
+      typeIndex += 1
 
       dataText = ''
       if (len(prms) > len(trivialConditions)):
@@ -748,9 +984,14 @@ def readAndGenerate(inputFiles, outputPath, scheme):
       dataText += 'public:\n'
       dataText += '\ttemplate <typename Other>\n'
       dataText += '\tstatic constexpr bool Is() { return std::is_same_v<std::decay_t<Other>, ' + fullDataName(name) + '>; };\n\n'
+      if (len(prms) > len(trivialConditions)) and isPooledData(restype, name):
+        dataText += '\tstatic constexpr bool kPooled = true;\n\n'
+      if (len(prms) > len(trivialConditions)) and compact:
+        dataText += '\tstatic constexpr ushort kTypeIndex = ' + str(typeIndex) + ';\n\n'
       creatorParams = []
       creatorParamsList = []
       readText = ''
+      skipText = ''
       writeText = ''
 
       if (hasFlags != ''):
@@ -784,60 +1025,251 @@ def readAndGenerate(inputFiles, outputPath, scheme):
       forwards += 'class ' + fullDataName(name) + ';\n'; # data class forward declaration
       if (len(prms) > len(trivialConditions)):
         dataText += '\t' + fullDataName(name) + '();\n'; # default constructor
-        switchLines += 'setData(new ' + fullDataName(name) + '()); '
+        switchLines += 'setData(tl::details::create<' + fullDataName(name) + '>()); '
 
         constructsBodies += fullDataName(name) + '::' + fullDataName(name) + '() = default;\n'
         constructsBodies += 'const ' + fullDataName(name) + ' &' + fullTypeName(restype) + '::c_' + name + '() const {\n'
         if (withType):
-          constructsBodies += '\tExpects(_type == ' + idPrefix + name + ');\n\n'
+          constructsBodies += '\tExpects(' + typeField + ' == ' + idPrefix + name + ');\n\n'
         constructsBodies += '\treturn queryData<' + fullDataName(name) + '>();\n'
         constructsBodies += '}\n'
 
         constructsText += '\texplicit ' + fullTypeName(restype) + '(const ' + fullDataName(name) + ' *data);\n'; # by-data type constructor
-        constructsBodies += fullTypeName(restype) + '::' + fullTypeName(restype) + '(const ' + fullDataName(name) + ' *data) : type_owner(data)'
-        if (withType):
+        constructsBodies += fullTypeName(restype) + '::' + fullTypeName(restype) + '(const ' + fullDataName(name) + ' *data) : ' + ownerClass + '(data)'
+        if (withType and not compact):
           constructsBodies += ', _type(' + idPrefix + name + ')'
         constructsBodies += ' {\n}\n'
 
+        lazyFields = []
+        if readWriteSection:
+          lazyFields = [paramName for paramName in prmsList if not (paramName in trivialConditions) and isLazyField(name, paramName, prms[paramName])]
+        sparseFields = []
+        if isSparseData(name):
+          sparseFields = [paramName for paramName in prmsList if (paramName in conditions) and not (paramName in trivialConditions) and not (paramName in lazyFields)]
+        def sparseGet(paramName):
+          return '_sparse.get<' + str(sparseFields.index(paramName)) + '>()'
+
         dataText += '\t' + fullDataName(name) + '('; # params constructor
         prmsStr = []
         prmsInit = []
+        prmsBody = ''
         for paramName in prmsList:
           if (paramName in trivialConditions):
             continue
           paramType = prms[paramName]
 
-          if (paramType in ['int', 'Int', 'bool', 'Bool']):
-            prmsStr.append(fullTypeName(paramType) + ' ' + paramName + '_')
-            creatorParams.append(fullTypeName(paramType) + ' ' + paramName + '_')
+          prmsStr.append(fullTypeName(paramType) + ' ' + paramName + '_')
+          creatorParams.append(fullTypeName(paramType) + ' ' + paramName + '_')
+          creatorParamsList.append(sinkParam(paramType, paramName + '_'))
+          if paramName in sparseFields:
+            prmsBody += '\tif (const auto value = ' + sparseGet(paramName) + ') {\n\t\t*value = ' + sinkParam(paramType, paramName + '_') + ';\n\t}\n'
           else:
-            prmsStr.append('const ' + fullTypeName(paramType) + ' &' + paramName + '_')
-            creatorParams.append('const ' + fullTypeName(paramType) + ' &' + paramName + '_')
-          creatorParamsList.append(paramName + '_')
-          prmsInit.append('_' + paramName + '(' + paramName + '_)')
+            prmsInit.append('_' + paramName + '(' + sinkParam(paramType, paramName + '_') + ')')
           if withType:
             writeText += '\t'
-          if (paramName in conditions):
+          if paramName == hasFlags:
+            skipText += '\t\t&& tl::details::skip_flags(from, end, flags)\n'
+          elif paramName in conditions:
+            skipText += '\t\t&& (!(flags & (1U << ' + conditions[paramName] + ')) || ' + fullTypeName(paramType) + '::skip(from, end, 0, stats))\n'
+          else:
+            skipText += '\t\t&& ' + fullTypeName(paramType) + '::skip(from, end, 0, stats)\n'
+          if paramName in sparseFields:
+            readText += '\t\t&& (!(_' + hasFlags + '.v & Flag::f_' + paramName + ') || ' + sparseGet(paramName) + '->read(from, end))\n'
+            writeText += '\tif (const auto v' + paramName + ' = v.v' + paramName + '()) v' + paramName + '->write(to);\n'
+          elif (paramName in conditions) and (paramName in lazyFields):
+            readText += '\t\t&& (!(_' + hasFlags + '.v & Flag::f_' + paramName + ') || _' + paramName + '.read(from, end))\n'
+            writeText += '\tif (const auto l' + paramName + ' = v.l' + paramName + '()) l' + paramName + '->write(to);\n'
+          elif paramName in lazyFields:
+            readText += '\t\t&& _' + paramName + '.read(from, end)\n'
+            writeText += '\tv.l' + paramName + '().write(to);\n'
+          elif (paramName in conditions):
             readText += '\t\t&& (v' + paramName + '() ? _' + paramName + '.read(from, end) : ((_' + paramName + ' = ' + fullTypeName(paramType) + '()), true))\n'
             writeText += '\tif (const auto v' + paramName + ' = v.v' + paramName + '()) v' + paramName + '->write(to);\n'
           else:
             readText += '\t\t&& _' + paramName + '.read(from, end)\n'
             writeText += '\tv.v' + paramName + '().write(to);\n'
+            if sparseFields and paramName == hasFlags:
+              readText += '\t\t&& (_sparse.reset(_' + hasFlags + '.v.value()), true)\n'
+              prmsBody = '\t_sparse.reset(_' + hasFlags + '.v.value());\n' + prmsBody
 
         dataText += ', '.join(prmsStr) + ');\n'
 
-        constructsBodies += fullDataName(name) + '::' + fullDataName(name) + '(' + ', '.join(prmsStr) + ') : ' + ', '.join(prmsInit) + ' {\n}\n'
+        constructsBodies += fullDataName(name) + '::' + fullDataName(name) + '(' + ', '.join(prmsStr) + ') : ' + ', '.join(prmsInit) + ' {\n' + prmsBody + '}\n'
+
+        fixedFields = fixedLayoutFields(prmsList, prms, hasFlags, trivialConditions)
+        if fixedFields:
+          dataText += '\n\tstatic constexpr uint32 kEncodedPrimes = ' + fixedLayoutPrimes(fixedFields, prms) + ';\n'
+          readText = '\t\t&& tl::details::read_fixed(from, end, ' + ', '.join('_' + paramName for paramName in fixedFields) + ')\n'
+          skipText = '\t\t&& tl::details::skip_primes(from, end, kEncodedPrimes)\n'
+          writeText = ('\t' if withType else '') + '\ttl::details::write_fixed(to, ' + ', '.join('v.v' + paramName + '()' for paramName in fixedFields) + ');\n'
 
         if readWriteSection:
           dataText += '\n'
-          dataText += '\t[[nodiscard]] bool read(const ' + primeType + ' *&from, const ' + primeType + ' *end);\n'
-
-          constructsBodies += 'bool ' + fullDataName(name) + '::read(const ' + primeType + ' *&from, const ' + primeType + ' *end) {\n'
-          if readText != '':
+          dataText += '\ttemplate <typename Prime>\n'
+          dataText += '\t[[nodiscard]] bool read(const Prime *&from, const Prime *end);\n'
+
+          constructsBodies += 'template <typename Prime>\n'
+          constructsBodies += 'bool ' + fullDataName(name) + '::read(const Prime *&from, const Prime *end) {\n'
+          memoized = isMemoizedData(restype, name)
+          if memoized:
+            constructsBodies += '\tconst auto start = from;\n'
+            constructsBodies += '\tconst auto memoizing = tl::details::memoizing_read();\n'
+            constructsBodies += '\tconst auto result =' + readText[4:len(readText)-1] + ';\n'
+            constructsBodies += '\tif (result && memoizing.active()) {\n'
+            constructsBodies += '\t\t_encoding.set(QByteArray(reinterpret_cast<const char *>(start), (from - start) * sizeof(Prime)));\n'
+            constructsBodies += '\t}\n'
+            constructsBodies += '\treturn result;\n'
+          elif readText != '':
             constructsBodies += '\treturn' + readText[4:len(readText)-1] + ';\n'
           else:
             constructsBodies += '\treturn true;\n'
           constructsBodies += '}\n'
+          constructsBodies += readInstantiations(fullDataName(name) + '::read', '')
+
+          dataText += '\ttemplate <typename Prime>\n'
+          dataText += '\t[[nodiscard]] static bool skip(const Prime *&from, const Prime *end, tl::skip_stats *stats);\n'
+          constructsBodies += 'template <typename Prime>\n'
+          constructsBodies += 'bool ' + fullDataName(name) + '::skip(const Prime *&from, const Prime *end, tl::skip_stats *stats) {\n'
+          if hasFlags != '' and not fixedFields:
+            constructsBodies += '\tauto flags = uint32();\n'
+          constructsBodies += '\treturn' + skipText[4:len(skipText)-1] + ';\n'
+          constructsBodies += '}\n'
+          constructsBodies += readInstantiations(fullDataName(name) + '::skip', ', tl::skip_stats *stats')
+
+          seekText = ''
+          for paramName in prmsList:
+            if (paramName in trivialConditions):
+              continue
+            dataText += '\t[[nodiscard]] static bool seek_' + paramName + '(const ' + primeType + ' *&from, const ' + primeType + ' *end);\n'
+            constructsBodies += 'bool ' + fullDataName(name) + '::seek_' + paramName + '(const ' + primeType + ' *&from, const ' + primeType + ' *end) {\n'
+            if (paramName in conditions):
+              seekText += '\t\t&& (flags & (1U << ' + conditions[paramName] + '))\n'
+            if seekText != '':
+              if 'skip_flags' in seekText:
+                constructsBodies += '\tauto flags = uint32();\n'
+              constructsBodies += '\treturn' + seekText[4:len(seekText)-1] + ';\n'
+            else:
+              constructsBodies += '\treturn true;\n'
+            constructsBodies += '}\n'
+            if (paramName in conditions):
+              seekText = seekText[:seekText.rindex('\t\t&& ')]
+              seekText += '\t\t&& (!(flags & (1U << ' + conditions[paramName] + ')) || ' + fullTypeName(prms[paramName]) + '::skip(from, end))\n'
+            elif paramName == hasFlags:
+              seekText += '\t\t&& tl::details::skip_flags(from, end, flags)\n'
+            else:
+              seekText += '\t\t&& ' + fullTypeName(prms[paramName]) + '::skip(from, end)\n'
+
+          if frozen:
+            frozenFields = [paramName for paramName in prmsList if not (paramName in trivialConditions)]
+            frozenName = fullDataName(name) + '::Frozen'
+            def frozenValue(paramName):
+              return 'tl::details::frozen_value<' + fullTypeName(prms[paramName]) + '>'
+            def frozenSlot(paramName):
+              return 'kSlots[' + str(frozenFields.index(paramName)) + ']'
+            dataText += '\n\tclass Frozen;\n'
+            dataText += '\tvoid freeze(tl::details::frozen_writer &to, uint32 slot) const;\n'
+            constructsBodies += 'void ' + fullDataName(name) + '::freeze(tl::details::frozen_writer &to, uint32 slot) const {\n'
+            constructsBodies += '\tconst auto record = to.record(slot, ' + idPrefix + name + ', Frozen::kSlots.back()) + 1;\n'
+            for paramName in frozenFields:
+              if (paramName in conditions):
+                constructsBodies += '\tif (const auto value = v' + paramName + '()) {\n'
+                constructsBodies += '\t\t' + frozenValue(paramName) + '::put(to, record + Frozen::' + frozenSlot(paramName) + ', *value);\n'
+                constructsBodies += '\t}\n'
+              else:
+                constructsBodies += '\t' + frozenValue(paramName) + '::put(to, record + Frozen::' + frozenSlot(paramName) + ', v' + paramName + '());\n'
+            constructsBodies += '}\n'
+
+            frozenText = 'class ' + frozenName + ' {\npublic:\n'
+            frozenText += '\tFrozen() = default;\n'
+            frozenText += '\tFrozen(const uint32 *base, uint32 record);\n\n'
+            frozenText += '\tstatic constexpr auto kSlots = tl::details::frozen_slots<' + ', '.join(fullTypeName(prms[paramName]) for paramName in frozenFields) + '>();\n\n'
+            constructsBodies += frozenName + '::Frozen(const uint32 *base, uint32 record) : _base(base), _record(record + 1) {\n}\n'
+            for paramName in prmsList:
+              if (paramName in trivialConditions):
+                frozenText += '\t[[nodiscard]] bool is_' + paramName + '() const;\n'
+                constructsBodies += 'bool ' + frozenName + '::is_' + paramName + '() const {\n'
+                constructsBodies += '\treturn v' + hasFlags + '().v & Flag::f_' + paramName + ';\n'
+                constructsBodies += '}\n'
+                continue
+              viewType = 'tl::frozen_t<' + fullTypeName(prms[paramName]) + '>'
+              if (paramName in conditions):
+                viewType = 'std::optional<' + viewType + '>'
+              frozenText += '\t[[nodiscard]] ' + viewType + ' v' + paramName + '() const;\n'
+              constructsBodies += viewType + ' ' + frozenName + '::v' + paramName + '() const {\n'
+              if (paramName in conditions):
+                constructsBodies += '\tif (!(v' + hasFlags + '().v & Flag::f_' + paramName + ')) {\n\t\treturn std::nullopt;\n\t}\n'
+              constructsBodies += '\treturn ' + frozenValue(paramName) + '::get(_base, _record + ' + frozenSlot(paramName) + ');\n'
+              constructsBodies += '}\n'
+            thawArguments = []
+            for paramName in frozenFields:
+              if (paramName in conditions):
+                thawArguments.append('v' + paramName + '() ? ' + frozenValue(paramName) + '::thaw(*v' + paramName + '()) : ' + fullTypeName(prms[paramName]) + '()')
+              else:
+                thawArguments.append(frozenValue(paramName) + '::thaw(v' + paramName + '())')
+            frozenText += '\n\t[[nodiscard]] ' + fullTypeName(restype) + ' thaw() const;\n'
+            constructsBodies += fullTypeName(restype) + ' ' + frozenName + '::thaw() const {\n'
+            constructsBodies += '\treturn ' + constructPrefix + name + '(\n\t\t' + ',\n\t\t'.join(thawArguments) + ');\n'
+            constructsBodies += '}\n'
+            checkText = ''
+            for paramName in frozenFields:
+              if (paramName in conditions):
+                flagsSlot = 'record + 1 + ' + frozenSlot(hasFlags)
+                checkText += '\t\t&& (!(checker.word(' + flagsSlot + ') & (1U << ' + conditions[paramName] + ')) || ' + frozenValue(paramName) + '::check(checker, record + 1 + ' + frozenSlot(paramName) + '))\n'
+              else:
+                checkText += '\t\t&& ' + frozenValue(paramName) + '::check(checker, record + 1 + ' + frozenSlot(paramName) + ')\n'
+            frozenText += '\t[[nodiscard]] static bool check(tl::details::frozen_checker &checker, uint32 record);\n'
+            constructsBodies += 'bool ' + frozenName + '::check(tl::details::frozen_checker &checker, uint32 record) {\n'
+            constructsBodies += '\treturn checker.claim(1 + kSlots.back())' + ('\n' + checkText[:-1] if checkText else '') + ';\n'
+            constructsBodies += '}\n'
+            frozenText += '\nprivate:\n'
+            frozenText += '\tconst uint32 *_base = nullptr;\n'
+            frozenText += '\tuint32 _record = 0;\n\n'
+            frozenText += '};\n'
+            frozenTexts += frozenText
+
+          writeTabs = 2 if withType else 1
+          variableLength = any(not isFixedWidth(prms[paramName]) for paramName in prmsList if not paramName in trivialConditions)
+          if cachedLength and variableLength:
+            dataText += '\t[[nodiscard]] uint32 encodedLength() const;\n'
+            constructsBodies += 'uint32 ' + fullDataName(name) + '::encodedLength() const {\n'
+            constructsBodies += '\treturn _encodedLength.get([&] {\n'
+            constructsBodies += '\t\tauto to = tl::details::LengthCounter();\n'
+            constructsBodies += '\t\tconst auto &v = *this;\n'
+            constructsBodies += reindentLines(writeText, writeTabs, 2)
+            constructsBodies += '\t\treturn to.length;\n'
+            constructsBodies += '\t});\n'
+            constructsBodies += '}\n'
+            writeIndent = '\t' * writeTabs
+            writeText = writeIndent + 'if constexpr (std::is_same_v<Accumulator, tl::details::LengthCounter>) {\n' \
+              + writeIndent + '\tto.length += v.encodedLength();\n' \
+              + writeIndent + '} else {\n' \
+              + reindentLines(writeText, writeTabs, writeTabs + 1) \
+              + writeIndent + '}\n'
+          if memoized:
+            dataText += '\t[[nodiscard]] const tl::details::cached_encoding &encoding() const;\n'
+            constructsBodies += 'const tl::details::cached_encoding &' + fullDataName(name) + '::encoding() const {\n'
+            constructsBodies += '\treturn _encoding;\n'
+            constructsBodies += '}\n'
+            writeIndent = '\t' * writeTabs
+            writeText = writeIndent + 'if (const auto encoded = v.encoding().get()) {\n' \
+              + writeIndent + '\ttl::details::put_encoded(to, *encoded);\n' \
+              + writeIndent + '} else {\n' \
+              + reindentLines(writeText, writeTabs, writeTabs + 1) \
+              + writeIndent + '}\n'
+            memoizer += ('\tcase ' + idPrefix + name + ': ' if withType else '\t') + 'tl::details::memoize(*this, c_' + name + '().encoding());' + (' break;\n' if withType else '\n')
+
+        if localCounting:
+          dataText += '\tvoid publish() const;\n'
+          constructsBodies += 'void ' + fullDataName(name) + '::publish() const {\n'
+          for paramName in prmsList:
+            if (paramName in trivialConditions) or not mayHoldData(prms[paramName]):
+              continue
+            elif paramName in sparseFields:
+              constructsBodies += '\tif (const auto value = ' + sparseGet(paramName) + ') {\n\t\ttl::publish(*value);\n\t}\n'
+            else:
+              constructsBodies += '\ttl::publish(_' + paramName + ');\n'
+          constructsBodies += '}\n'
+          publisher += ('\tcase ' + idPrefix + name + ': ' if withType else '\t') + 'c_' + name + '().publish();' + (' break;\n' if withType else '\n')
 
         dataText += '\n'
         if len(prmsList) > 0:
@@ -848,29 +1280,54 @@ def readAndGenerate(inputFiles, outputPath, scheme):
             if (paramName in conditions):
               dataText += '\t[[nodiscard]] tl::conditional<' + fullTypeName(paramType) + '> v' + paramName + '() const;\n'
               constructsBodies += 'tl::conditional<' + fullTypeName(paramType) + '> ' + fullDataName(name) + '::v' + paramName + '() const {\n'
-              constructsBodies += '\treturn (_' + hasFlags + '.v & Flag::f_' + paramName + ') ? &_' + paramName + ' : nullptr;\n'
+              if paramName in sparseFields:
+                constructsBodies += '\treturn ' + sparseGet(paramName) + ';\n'
+              elif paramName in lazyFields:
+                constructsBodies += '\treturn (_' + hasFlags + '.v & Flag::f_' + paramName + ') ? &_' + paramName + '.get() : nullptr;\n'
+              else:
+                constructsBodies += '\treturn (_' + hasFlags + '.v & Flag::f_' + paramName + ') ? &_' + paramName + ' : nullptr;\n'
               constructsBodies += '}\n'
             else:
               dataText += '\t[[nodiscard]] const ' + fullTypeName(paramType) + ' &v' + paramName + '() const;\n'
               constructsBodies += 'const ' + fullTypeName(paramType) + ' &' + fullDataName(name) + '::v' + paramName + '() const {\n'
-              constructsBodies += '\treturn _' + paramName + ';\n'
+              constructsBodies += '\treturn _' + paramName + ('.get()' if paramName in lazyFields else '') + ';\n'
               constructsBodies += '}\n'
+          for paramName in lazyFields: # undecoded lazy fields, written without decoding them
+            paramType = lazyTypeName(prms[paramName])
+            if (paramName in conditions):
+              dataText += '\t[[nodiscard]] tl::conditional<' + paramType + '> l' + paramName + '() const;\n'
+              constructsBodies += 'tl::conditional<' + paramType + '> ' + fullDataName(name) + '::l' + paramName + '() const {\n'
+              constructsBodies += '\treturn (_' + hasFlags + '.v & Flag::f_' + paramName + ') ? &_' + paramName + ' : nullptr;\n'
+            else:
+              dataText += '\t[[nodiscard]] const ' + paramType + ' &l' + paramName + '() const;\n'
+              constructsBodies += 'const ' + paramType + ' &' + fullDataName(name) + '::l' + paramName + '() const {\n'
+              constructsBodies += '\treturn _' + paramName + ';\n'
+            constructsBodies += '}\n'
           dataText += '\n'
           dataText += 'private:\n'
           for paramName in prmsList: # fields declaration
-            if (paramName in trivialConditions):
+            if (paramName in trivialConditions) or (paramName in sparseFields):
               continue
             paramType = prms[paramName]
-            dataText += '\t' + fullTypeName(paramType) + ' _' + paramName + ';\n'
+            dataText += '\t' + (lazyTypeName(paramType) if paramName in lazyFields else fullTypeName(paramType)) + ' _' + paramName + ';\n'
+          if sparseFields:
+            sparseTypes = ['tl::details::sparse_field<' + fullTypeName(prms[paramName]) + ', ' + conditions[paramName] + '>' for paramName in sparseFields]
+            dataText += '\ttl::details::sparse_storage<' + ', '.join(sparseTypes) + '> _sparse;\n'
+          if readWriteSection and cachedLength and variableLength:
+            dataText += '\ttl::details::cached_length _encodedLength;\n'
+          if readWriteSection and memoized:
+            dataText += '\ttl::details::cached_encoding _encoding;\n'
           dataText += '\n'
-        newFast = 'new ' + fullDataName(name) + '()'
+        newFast = 'tl::details::create<' + fullDataName(name) + '>()'
       else:
         constructsBodies += 'const ' + fullDataName(name) + ' &' + fullTypeName(restype) + '::c_' + name + '() const {\n'
         if (withType):
-          constructsBodies += '\tExpects(_type == ' + idPrefix + name + ');\n\n'
+          constructsBodies += '\tExpects(' + typeField + ' == ' + idPrefix + name + ');\n\n'
         constructsBodies += '\tstatic const ' + fullDataName(name) + ' result;\n'
         constructsBodies += '\treturn result;\n'
         constructsBodies += '}\n'
+        if compact:
+          switchLines += 'setData(tl::details::shared_type_data<' + str(typeIndex) + '>()); '
 
       if writeConversion and not restype in builtinTypes and not restype in conversionBuiltinTypes:
         conversionHeader += fullTypeName(restype) + ' tl_from(' + conversionPointer(name) + ' &&value);\n'
@@ -907,7 +1364,7 @@ def readAndGenerate(inputFiles, outputPath, scheme):
         friendDecl += '\tfriend class ::' + creatorNamespaceFull + '::TypeCreator;\n'
       creatorProxyText += '\tinline static ' + fullTypeName(restype) + ' new_' + name + '(' + ', '.join(creatorParams) + ') {\n'
       if len(prms) > len(trivialConditions): # creator with params
-        creatorProxyText += '\t\treturn ' + fullTypeName(restype) + '(new ' + fullDataName(name) + '(' + ', '.join(creatorParamsList) + '));\n'
+        creatorProxyText += '\t\treturn ' + fullTypeName(restype) + '(tl::details::create<' + fullDataName(name) + '>(' + ', '.join(creatorParamsList) + '));\n'
       else:
         if withType: # creator by type
           creatorProxyText += '\t\treturn ' + fullTypeName(restype) + '(' + idPrefix + name + ');\n'
@@ -919,36 +1376,63 @@ def readAndGenerate(inputFiles, outputPath, scheme):
       creatorsBodies += '\treturn ::' + creatorNamespaceFull + '::TypeCreator::new_' + name + '(' + ', '.join(creatorParamsList) + ');\n'
       creatorsBodies += '}\n'
 
+      if frozen:
+        caseText = ('\tcase ' + idPrefix + name + ': ') if withType else '\t'
+        if (len(prms) > len(trivialConditions)):
+          freezer += caseText + 'c_' + name + '().freeze(to, slot);' + (' break;\n' if withType else '\n')
+          thawer += caseText + 'return c_' + name + '().thaw();\n'
+          frozenChecker += caseText + 'return ' + ('' if withType else '(checker.word(record) == ' + idPrefix + name + ') && ') + fullDataName(name) + '::Frozen::check(checker, record);\n'
+          frozenGetters += '\t[[nodiscard]] ' + fullDataName(name) + '::Frozen c_' + name + '() const;\n'
+          methods += fullDataName(name) + '::Frozen ' + fullTypeName(restype) + '::Frozen::c_' + name + '() const {\n'
+          if (withType):
+            methods += '\tExpects(type() == ' + idPrefix + name + ');\n\n'
+          methods += '\treturn ' + fullDataName(name) + '::Frozen(_base, _record);\n'
+          methods += '}\n'
+        else:
+          freezer += caseText + 'to.record(slot, ' + idPrefix + name + ', 0);' + (' break;\n' if withType else '\n')
+          thawer += caseText + 'return ' + constructPrefix + name + '();\n'
+          frozenChecker += caseText + 'return ' + ('' if withType else '(checker.word(record) == ' + idPrefix + name + ') && ') + 'checker.claim(1);\n'
+
       if (withType):
-        reader += '\tcase ' + idPrefix + name + ': _type = cons; '; # read switch line
+        reader += '\tcase ' + idPrefix + name + ': ' + ('' if compact else '_type = cons; '); # read switch line
         if (len(prms) > len(trivialConditions)):
           reader += '{\n'
-          reader += '\t\tif (const auto data = new ' + fullDataName(name) + '(); data->read(from, end)) {\n'
+          reader += '\t\tif (const auto data = tl::details::create<' + fullDataName(name) + '>(); data->read(from, end)) {\n'
           reader += '\t\t\tsetData(data);\n'
           reader += '\t\t} else {\n'
-          reader += '\t\t\tdelete data;\n'
+          reader += '\t\t\ttl::details::destroy(data);\n'
           reader += '\t\t\treturn false;\n'
           reader += '\t\t}\n'
           reader += '\t} break;\n'
 
+          skipper += '\tcase ' + idPrefix + name + ': return ' + fullDataName(name) + '::skip(from, end, stats);\n'
+
           writer += '\tcase ' + idPrefix + name + ': {\n'; # write switch line
           writer += '\t\tconst ' + fullDataName(name) + ' &v = c_' + name + '();\n'
           writer += writeText
           writer += '\t} break;\n'
         else:
-          reader += 'break;\n'
+          skipper += '\tcase ' + idPrefix + name + ': return true;\n'
+          if compact:
+            reader += 'setData(tl::details::shared_type_data<' + str(typeIndex) + '>()); break;\n'
+          else:
+            reader += 'break;\n'
       else:
         if (len(prms) > len(trivialConditions)):
-          reader += '\tif (const auto data = new ' + fullDataName(name) + '(); data->read(from, end)) {\n'
+          reader += '\tif (const auto data = tl::details::create<' + fullDataName(name) + '>(); data->read(from, end)) {\n'
           reader += '\t\tsetData(data);\n'
           reader += '\t} else {\n'
-          reader += '\t\tdelete data;\n'
+          reader += '\t\ttl::details::destroy(data);\n'
           reader += '\t\treturn false;\n'
           reader += '\t}\n'
 
           writer += '\tconst ' + fullDataName(name) + ' &v = c_' + name + '();\n'
           writer += writeText
 
+          skipper += '\treturn ' + fullDataName(name) + '::skip(from, end, stats);\n'
+        else:
+          skipper += '\treturn true;\n'
+
     if nullable:
       if not withType and not withData:
         print('No way to make a nullable non-data-owner non-type-distinct type')
@@ -961,12 +1445,12 @@ def readAndGenerate(inputFiles, outputPath, scheme):
 
     typesText += '\nclass ' + fullTypeName(restype); # type class declaration
     if withData:
-      typesText += ' : private tl::details::type_owner'; # if has data fields
+      typesText += ' : private ' + ownerClass; # if has data fields
     typesText += ' {\n'
     typesText += 'public:\n'
     typesText += '\t' + fullTypeName(restype) + '();\n'; # default constructor
     if withData and not withType:
-      methods += '\n' + fullTypeName(restype) + '::' + fullTypeName(restype) + '() : type_owner(' + newFast + ') {\n}\n'
+      methods += '\n' + fullTypeName(restype) + '::' + fullTypeName(restype) + '() : ' + ownerClass + '(' + newFast + ') {\n}\n'
     else:
       methods += '\n' + fullTypeName(restype) + '::' + fullTypeName(restype) + '() = default;\n'
 
@@ -989,7 +1473,7 @@ def readAndGenerate(inputFiles, outputPath, scheme):
     visitorMethods += 'template <typename Method, typename ...Methods>\n'
     visitorMethods += 'decltype(auto) ' + fullTypeName(restype) + '::match(Method &&method, Methods &&...methods) const {\n'
     if withType:
-      visitorMethods += '\tswitch (_type) {\n'
+      visitorMethods += '\tswitch (' + typeField + ') {\n'
       visitorMethods += visitor
       visitorMethods += '\t}\n'
       visitorMethods += '\tUnexpected("Type in ' + fullTypeName(restype) + '::match.");\n'
@@ -999,7 +1483,13 @@ def readAndGenerate(inputFiles, outputPath, scheme):
 
     typesText += '\t' + typeIdType + ' type() const;\n'; # type id method
     methods += typeIdType + ' ' + fullTypeName(restype) + '::type() const {\n'
-    if withType:
+    if compact:
+      if nullable:
+        methods += '\treturn typeFromData();\n'
+      else:
+        methods += '\tExpects(hasData());\n\n'
+        methods += '\treturn typeFromData();\n'
+    elif withType:
       if nullable:
         methods += '\treturn _type;\n'
       else:
@@ -1014,11 +1504,13 @@ def readAndGenerate(inputFiles, outputPath, scheme):
 
     if readWriteSection:
       typesText += '\n'
-      typesText += '\t[[nodiscard]] bool read(const ' + primeType + ' *&from, const ' + primeType + ' *end, ' + typeIdType + ' cons'; # read method
+      typesText += '\ttemplate <typename Prime>\n'
+      typesText += '\t[[nodiscard]] bool read(const Prime *&from, const Prime *end, ' + typeIdType + ' cons'; # read method
       if (not withType):
         typesText += ' = ' + idPrefix + name
       typesText += ');\n'
-      methods += 'bool ' + fullTypeName(restype) + '::read(const ' + primeType + ' *&from, const ' + primeType + ' *end, ' + typeIdType + ' cons) {\n'
+      methods += 'template <typename Prime>\n'
+      methods += 'bool ' + fullTypeName(restype) + '::read(const Prime *&from, const Prime *end, ' + typeIdType + ' cons) {\n'
       if (withData):
         if not (withType):
           methods += '\tif (cons != ' + idPrefix + v[0][0] + ') return false;\n'
@@ -1031,28 +1523,132 @@ def readAndGenerate(inputFiles, outputPath, scheme):
         methods += reader
       methods += '\treturn true;\n'
       methods += '}\n'
+      methods += readInstantiations(fullTypeName(restype) + '::read', ', ' + typeIdType + ' cons')
+
+      typesText += '\ttemplate <typename Prime>\n'
+      typesText += '\t[[nodiscard]] static bool skip(const Prime *&from, const Prime *end, ' + typeIdType + ' cons = 0, tl::skip_stats *stats = nullptr);\n'
+      methods += 'template <typename Prime>\n'
+      methods += 'bool ' + fullTypeName(restype) + '::skip(const Prime *&from, const Prime *end, ' + typeIdType + ' cons, tl::skip_stats *stats) {\n'
+      if (withType):
+        methods += '\tif (stats) ++stats->objects;\n'
+        methods += '\tswitch (cons) {\n'
+        methods += skipper
+        methods += '\tdefault: return false;\n'
+        methods += '\t}\n'
+      else:
+        methods += '\tif (cons && cons != ' + idPrefix + v[0][0] + ') return false;\n'
+        methods += '\tif (stats) ++stats->objects;\n'
+        methods += skipper
+      methods += '}\n'
+      methods += readInstantiations(fullTypeName(restype) + '::skip', ', ' + typeIdType + ' cons, tl::skip_stats *stats')
+
+      if frozen:
+        typesText += '\n\tclass Frozen;\n'
+        typesText += '\tvoid freeze(tl::details::frozen_writer &to, uint32 slot) const;\n'
+        methods += 'void ' + fullTypeName(restype) + '::freeze(tl::details::frozen_writer &to, uint32 slot) const {\n'
+        if (withType):
+          methods += '\tswitch (' + typeField + ') {\n'
+          methods += freezer
+          methods += '\t}\n'
+        else:
+          methods += freezer
+        methods += '}\n'
+
+        frozenName = fullTypeName(restype) + '::Frozen'
+        frozenText = 'class ' + frozenName + ' {\npublic:\n'
+        frozenText += '\tFrozen() = default;\n'
+        frozenText += '\tFrozen(const uint32 *base, uint32 record);\n\n'
+        frozenText += '\t[[nodiscard]] ' + typeIdType + ' type() const;\n'
+        frozenText += frozenGetters
+        frozenText += '\n\t[[nodiscard]] ' + fullTypeName(restype) + ' thaw() const;\n'
+        frozenText += '\t[[nodiscard]] static bool check(tl::details::frozen_checker &checker, uint32 slot);\n'
+        frozenText += '\nprivate:\n'
+        frozenText += '\tconst uint32 *_base = nullptr;\n'
+        frozenText += '\tuint32 _record = 0;\n\n'
+        frozenText += '};\n'
+        frozenTexts += frozenText
+        methods += frozenName + '::Frozen(const uint32 *base, uint32 record) : _base(base), _record(record) {\n}\n'
+        methods += typeIdType + ' ' + frozenName + '::type() const {\n'
+        methods += '\treturn _base[_record];\n'
+        methods += '}\n'
+        methods += fullTypeName(restype) + ' ' + frozenName + '::thaw() const {\n'
+        if (withType):
+          methods += '\tswitch (type()) {\n'
+          methods += thawer
+          methods += '\t}\n'
+          methods += '\tUnexpected("Type in ' + frozenName + '::thaw.");\n'
+        else:
+          methods += thawer
+        methods += '}\n'
+        methods += 'bool ' + frozenName + '::check(tl::details::frozen_checker &checker, uint32 slot) {\n'
+        methods += '\tauto record = uint32();\n'
+        methods += '\tif (!checker.record(slot, record)) {\n'
+        methods += '\t\treturn false;\n'
+        methods += '\t}\n'
+        if (withType):
+          methods += '\tswitch (checker.word(record)) {\n'
+          methods += frozenChecker
+          methods += '\t}\n'
+          methods += '\treturn false;\n'
+        else:
+          methods += frozenChecker
+        methods += '}\n'
+
+      if streaming:
+        typesText += '\n\tstatic constexpr uint32 kStreamType = ' + str(streamTypeIndex[restype]) + ';\n'
+        typesText += '\t[[nodiscard]] static const tl::details::stream_scheme &StreamScheme();\n\n'
+        methods += 'const tl::details::stream_scheme &' + fullTypeName(restype) + '::StreamScheme() {\n'
+        methods += '\treturn kStreamScheme;\n'
+        methods += '}\n'
+        streamTypes.append('{ ' + str(len(streamConstructors)) + ', ' + str(len(v)) + ' }')
+        for data in v:
+          streamConstructors.append('{ ' + idPrefix + data[0] + ', ' + str(sum(len(program) for program in streamOps)) + ' }')
+          streamOps.append(streamProgram(data[2], data[3], data[4], data[6], data[7]))
 
       typesText += '\ttemplate <typename Accumulator>\n' # write method
       typesText += '\tvoid write(Accumulator &to) const;\n'
       methods += 'template <typename Accumulator>\n'
       methods += 'void ' + fullTypeName(restype) + '::write(Accumulator &to) const {\n'
       if (withType and writer != ''):
-        methods += '\tswitch (_type) {\n'
+        methods += '\tswitch (' + typeField + ') {\n'
         methods += writer
         methods += '\t}\n'
       else:
         methods += writer
       methods += '}\n'
-      methods += 'template void ' + fullTypeName(restype) + '::write<' + bufferType + '>(' + bufferType + ' &to) const;\n'
-      methods += 'template void ' + fullTypeName(restype) + '::write<::tl::details::LengthCounter>(::tl::details::LengthCounter &to) const;\n'
+      methods += writeInstantiations(fullTypeName(restype))
+
+    if localCounting and withData:
+      typesText += '\tvoid publish() const;\n'
+      methods += 'void ' + fullTypeName(restype) + '::publish() const {\n'
+      methods += '\tif (!publishData()) {\n\t\treturn;\n\t}\n'
+      if withType:
+        methods += '\tswitch (' + typeField + ') {\n'
+        methods += publisher
+        methods += '\t}\n'
+      else:
+        methods += publisher
+      methods += '}\n'
+
+    if memoizer != '':
+      typesText += '\tvoid memoize() const;\n'
+      methods += 'void ' + fullTypeName(restype) + '::memoize() const {\n'
+      if withType:
+        methods += '\tswitch (' + typeField + ') {\n'
+        methods += memoizer
+        methods += '\t}\n'
+      else:
+        methods += memoizer
+      methods += '}\n'
 
     typesText += '\n\tusing ResponseType = void;\n'; # no response types declared
 
     typesText += '\nprivate:\n'; # private constructors
     if (withType): # by-type-id constructor
       typesText += '\texplicit ' + fullTypeName(restype) + '(' + typeIdType + ' type);\n'
-      methods += fullTypeName(restype) + '::' + fullTypeName(restype) + '(' + typeIdType + ' type) : '
-      methods += '_type(type)'
+      methods += fullTypeName(restype) + '::' + fullTypeName(restype) + '(' + typeIdType + ' type)'
+      if not compact:
+        methods += ' : _type(type)'
       methods += ' {\n'
       methods += '\tswitch (type) {\n'; # type id check
       methods += switchLines
@@ -1067,7 +1663,13 @@ def readAndGenerate(inputFiles, outputPath, scheme):
     if (friendDecl):
       typesText += '\n' + friendDecl
 
-    if (withType):
+    if (compact):
+      typesText += '\n\t' + typeIdType + ' typeFromData() const;\n'
+      methods += typeIdType + ' ' + fullTypeName(restype) + '::typeFromData() const {\n'
+      methods += '\tstatic constexpr ' + typeIdType + ' kTypes[] = { ' + typeIdType + '(0), ' + ', '.join(idPrefix + data[0] for data in v) + ' };\n\n'
+      methods += '\treturn kTypes[dataTypeIndex()];\n'
+      methods += '}\n'
+    elif (withType):
       typesText += '\n\t' + typeIdType + ' _type = 0;\n'; # type field var
 
     typesText += '};\n'; # type class ended
@@ -1079,6 +1681,15 @@ def readAndGenerate(inputFiles, outputPath, scheme):
 
   flagOperators += '\n'
 
+  if streaming:
+    streamTables = 'namespace {\n\n'
+    streamTables += 'constexpr uint32 kStreamOps[] = {\n' + ''.join('\t' + ', '.join(program) + ',\n' for program in streamOps) + '};\n\n'
+    streamTables += 'constexpr tl::details::stream_constructor kStreamConstructors[] = {\n' + ''.join('\t' + entry + ',\n' for entry in streamConstructors) + '};\n\n'
+    streamTables += 'constexpr tl::details::stream_type kStreamTypes[] = {\n' + ''.join('\t' + entry + ',\n' for entry in streamTypes) + '};\n\n'
+    streamTables += 'const tl::details::stream_scheme kStreamScheme = { kStreamOps, kStreamConstructors, kStreamTypes };\n\n'
+    streamTables += '} // namespace\n\n'
+    methods = streamTables + methods
+
   for pureChildName in flagInheritance:
     childName = dataPrefix + pureChildName
     parentName = dataPrefix + flagInheritance[pureChildName]
@@ -1221,6 +1832,30 @@ bool DumpToTextType(DumpToTextBuffer &to, const ' + primeType + ' *&from, const
 	return true;\n\
 }\n'
 
+  # optional library headers are included only for the options in use
+  libraryIncludes = ['tl/tl_boxed.h', 'tl/tl_serialize.h', 'tl/tl_type_owner.h']
+  if frozen:
+    libraryIncludes.append('tl/tl_frozen.h')
+  if '::tl::gather_buffer' in accumulatorTypes:
+    libraryIncludes.append('tl/tl_gather.h')
+  if '::tl::gzip_buffer' in accumulatorTypes:
+    libraryIncludes.append('tl/tl_gzip.h')
+  if any(hasher in accumulatorTypes for hasher in ['::tl::crc32_hasher', '::tl::sha256_hasher', '::tl::xxh64_hasher']):
+    libraryIncludes.append('tl/tl_hash.h')
+  if '::tl::headroom_buffer' in accumulatorTypes:
+    libraryIncludes.append('tl/tl_headroom.h')
+  if len(lazyFieldNames) > 0:
+    libraryIncludes.append('tl/tl_lazy.h')
+  if len(memoizedTypes) > 0:
+    libraryIncludes.append('tl/tl_memoize.h')
+  if len(sparseConstructors) > 0:
+    libraryIncludes.append('tl/tl_sparse.h')
+  if streaming:
+    libraryIncludes.append('tl/tl_stream.h')
+  if ('std::byte' in readerTypes) or any(buffer in accumulatorTypes for buffer in ['std::string', 'std::vector<std::byte>']):
+    libraryIncludes.append('tl/tl_unaligned.h')
+  libraryIncludes.sort()
+
   # module itself
   header = '\
 // WARNING! All changes made in this file will be lost!\n\
@@ -1231,8 +1866,7 @@ bool DumpToTextType(DumpToTextBuffer &to, const ' + primeType + ' *&from, const
 ' + ('#include "' + builtinInclude + '"\n' if builtinInclude != '' else '') + '\
 #include "base/assertion.h"\n\
 #include "base/flags.h"\n\
-#include "tl/tl_boxed.h"\n\
-#include "tl/tl_type_owner.h"\n\
+' + ''.join(['#include "' + include + '"\n' for include in libraryIncludes]) + '\
 \n\
 ' + ('namespace ' + globalNamespace + ' {\n' if globalNamespace != '' else '') + '\
 ' + ('namespace ' + creatorNamespace + ' {\n' if creatorNamespace != '' else '') + '\
@@ -1254,6 +1888,7 @@ enum : std::uint32_t {\n\
 ' + typesText + '\n\
 // Type constructors with data\n\
 ' + dataTexts + '\n\
+' + ('// Frozen views definition\n' + frozenTexts + '\n' if frozenTexts != '' else '') + '\
 // RPC methods\n\
 ' + funcsText + '\n\
 // Template methods definition\n\
@@ -0,0 +1,137 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_arena.h"
+
+#include "base/algorithm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace tl {
+namespace details {
+namespace {
+
+constexpr auto kHeaderSize = sizeof(arena_data *);
+
+thread_local arena_data *CurrentArena = nullptr;
+
+[[nodiscard]] char *AlignUp(char *position, std::size_t alignment) {
+  const auto value = reinterpret_cast<std::uintptr_t>(position);
+  return position + ((alignment - (value % alignment)) % alignment);
+}
+
+}  // namespace
+
+arena_data::arena_data(std::size_t chunkSize) : _chunkSize(std::max(chunkSize, std::size_t(1024))) {
+}
+
+arena_data::~arena_data() {
+  while (_chunks) {
+    const auto next = _chunks->next;
+    ::operator delete(_chunks);
+    _chunks = next;
+  }
+}
+
+void arena_data::addChunk(std::size_t size) {
+  const auto memory = static_cast<char *>(::operator new(sizeof(chunk) + size));
+  const auto added = new (memory) chunk{_chunks};
+  _chunks = added;
+  _position = memory + sizeof(chunk);
+  _end = _position + size;
+}
+
+void *arena_data::allocate(std::size_t size, std::size_t alignment) {
+  auto result = AlignUp(_position, alignment);
+  if (!_position || result + size > _end) {
+    addChunk(std::max(_chunkSize, size + alignment));
+    result = AlignUp(_position, alignment);
+  }
+  _position = result + size;
+  _allocated += size;
+  return result;
+}
+
+void *arena_data::allocateObject(std::size_t size, std::size_t alignment) {
+  const auto header = std::max(kHeaderSize, alignment);
+  const auto memory = static_cast<char *>(allocate(header + size, alignment));
+  const auto result = memory + header;
+  const auto owner = this;
+  std::memcpy(result - kHeaderSize, &owner, kHeaderSize);
+  ref();
+  return result;
+}
+
+arena_data *arena_data::Owner(const void *object) {
+  auto result = (arena_data *)nullptr;
+  std::memcpy(&result, static_cast<const char *>(object) - kHeaderSize, kHeaderSize);
+  return result;
+}
+
+arena_data *current_arena() {
+  return CurrentArena;
+}
+
+}  // namespace details
+
+arena::arena(std::size_t chunkSize) : _data(new details::arena_data(chunkSize)) {
+}
+
+arena::arena(const arena &other) : _data(other._data) {
+  if (_data) {
+    _data->ref();
+  }
+}
+
+arena::arena(arena &&other) : _data(base::take(other._data)) {
+}
+
+arena &arena::operator=(const arena &other) {
+  if (_data != other._data) {
+    if (_data) {
+      _data->deref();
+    }
+    _data = other._data;
+    if (_data) {
+      _data->ref();
+    }
+  }
+  return *this;
+}
+
+arena &arena::operator=(arena &&other) {
+  if (_data != other._data) {
+    if (_data) {
+      _data->deref();
+    }
+    _data = base::take(other._data);
+  }
+  return *this;
+}
+
+arena::~arena() {
+  if (_data) {
+    _data->deref();
+  }
+}
+
+std::size_t arena::allocated() const {
+  return _data ? _data->allocated() : 0;
+}
+
+arena_scope::arena_scope(const arena &arena) : _previous(details::CurrentArena) {
+  Expects(arena._data != nullptr);
+
+  details::CurrentArena = arena._data;
+}
+
+arena_scope::~arena_scope() {
+  details::CurrentArena = _previous;
+}
+
+}  // namespace tl
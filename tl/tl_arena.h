@@ -0,0 +1,95 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <QtCore/QAtomicInt>
+
+namespace tl {
+namespace details {
+
+class arena_data final {
+ public:
+  explicit arena_data(std::size_t chunkSize);
+  arena_data(const arena_data &other) = delete;
+  arena_data &operator=(const arena_data &other) = delete;
+  ~arena_data();
+
+  void ref() {
+    _counter.ref();
+  }
+  void deref() {
+    if (!_counter.deref()) {
+      delete this;
+    }
+  }
+
+  // Each object keeps a reference to the arena until it is destroyed.
+  [[nodiscard]] void *allocateObject(std::size_t size, std::size_t alignment);
+  [[nodiscard]] static arena_data *Owner(const void *object);
+
+  [[nodiscard]] std::size_t allocated() const {
+    return _allocated;
+  }
+
+ private:
+  struct chunk {
+    chunk *next = nullptr;
+  };
+
+  [[nodiscard]] void *allocate(std::size_t size, std::size_t alignment);
+  void addChunk(std::size_t size);
+
+  QAtomicInt _counter = {1};
+  std::size_t _chunkSize = 0;
+  std::size_t _allocated = 0;
+  chunk *_chunks = nullptr;
+  char *_position = nullptr;
+  char *_end = nullptr;
+};
+
+[[nodiscard]] arena_data *current_arena();
+
+}  // namespace details
+
+// A region the whole tree of a decoded message can be placed in.
+// The memory is released at once, when this handle and every object
+// allocated from the region are gone.
+class arena final {
+ public:
+  static constexpr auto kDefaultChunkSize = std::size_t(64 * 1024);
+
+  explicit arena(std::size_t chunkSize = kDefaultChunkSize);
+  arena(const arena &other);
+  arena(arena &&other);
+  arena &operator=(const arena &other);
+  arena &operator=(arena &&other);
+  ~arena();
+
+  [[nodiscard]] std::size_t allocated() const;
+
+ private:
+  friend class arena_scope;
+
+  details::arena_data *_data = nullptr;
+};
+
+// While alive, generated data objects created on this thread are placed
+// in the arena. Only one thread at a time may allocate from an arena.
+class arena_scope final {
+ public:
+  explicit arena_scope(const arena &arena);
+  arena_scope(const arena_scope &other) = delete;
+  arena_scope &operator=(const arena_scope &other) = delete;
+  ~arena_scope();
+
+ private:
+  details::arena_data *_previous = nullptr;
+};
+
+}  // namespace tl
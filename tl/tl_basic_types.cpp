@@ -7,6 +7,47 @@
 #include "tl/tl_basic_types.h"
 
 namespace tl {
+namespace details {
+namespace {
+
+thread_local stream_read_scope *StreamRead = nullptr;
+
+}  // namespace
+
+stream_read_scope::stream_read_scope(const QVector<QByteArray> *payloads)
+: _payloads(payloads)
+, _previous(StreamRead) {
+  StreamRead = this;
+}
+
+stream_read_scope::~stream_read_scope() {
+  StreamRead = _previous;
+}
+
+bool stream_read_scope::finished() const {
+  return !_payloads || (_next == _payloads->size());
+}
+
+bool stream_payload(uint32 length, const QByteArray *&result) {
+  result = nullptr;
+  const auto scope = StreamRead;
+  if (!scope || !scope->_payloads) {
+    return true;
+  }
+  const auto &payloads = *scope->_payloads;
+  if (scope->_next == payloads.size()
+    || uint32(payloads[scope->_next].size()) != length) {
+    return false;
+  }
+  result = &payloads[scope->_next++];
+  return true;
+}
+
+bool reading_stream() {
+  return (StreamRead != nullptr);
+}
+
+}  // namespace details
 
 QString utf16(const QByteArray &v) {
   return QString::fromUtf8(v);
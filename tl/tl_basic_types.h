@@ -12,6 +12,9 @@
 
 #include <QtCore/QVector>
 
+#include <algorithm>
+#include <cstring>
+
 namespace tl {
 namespace details {
 
@@ -29,6 +32,52 @@ struct Writer;
 template <typename Prime>
 struct Reader;
 
+// Filled by the skip() methods, which validate an object
+// and advance past it without creating anything.
+struct skip_stats {
+  uint32 objects = 0;
+  uint32 bytes = 0;
+};
+
+namespace details {
+
+template <typename Prime>
+[[nodiscard]] bool skip_primes(const Prime *&from, const Prime *end, uint32 count) {
+  static_assert(sizeof(uint32) % sizeof(Prime) == 0);
+
+  if (!Reader<Prime>::Has(count, from, end)) {
+    return false;
+  }
+  from += count * (sizeof(uint32) / sizeof(Prime));
+  return true;
+}
+
+template <typename Prime>
+[[nodiscard]] bool skip_flags(const Prime *&from, const Prime *end, uint32 &flags) {
+  if (!Reader<Prime>::Has(1, from, end)) {
+    return false;
+  }
+  flags = static_cast<uint32>(Reader<Prime>::Get(from, end));
+  return true;
+}
+
+template <typename Prime>
+[[nodiscard]] bool skip_string(const Prime *&from, const Prime *end) {
+  if (!Reader<Prime>::Has(1, from, end)) {
+    return false;
+  }
+  const auto first = static_cast<uint32>(Reader<Prime>::Get(from, end));
+  const auto last = (first & 0xFFU);
+  if (last > 254) {
+    return false;
+  }
+  const auto remaining = (last == 254) ? (first >> 8) : (last > 3) ? (last - 3) : 0U;
+  return Reader<Prime>::HasBytes(remaining, from, end)
+    && skip_primes(from, end, (remaining + 3) / 4);
+}
+
+}  // namespace details
+
 template <>
 struct Writer<details::LengthCounter> final {
   static void PutBytes(details::LengthCounter &to, const void *bytes, uint32 count) {
@@ -78,6 +127,10 @@ class int_type {
     v = static_cast<int32>(Reader<Prime>::Get(from, end));
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_int) && details::skip_primes(from, end, 1);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, static_cast<uint32>(v));
@@ -114,6 +167,10 @@ class flags_type {
     v = Flags::from_raw(static_cast<typename Flags::Type>(Reader<Prime>::Get(from, end)));
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_flags) && details::skip_primes(from, end, 1);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, static_cast<uint32>(v.value()));
@@ -169,6 +226,10 @@ class long_type {
     v |= static_cast<uint64>(Reader<Prime>::Get(from, end)) << 32;
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_long) && details::skip_primes(from, end, 2);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, static_cast<uint32>(v & 0xFFFFFFFFULL));
@@ -211,6 +272,10 @@ class int64_type {
     v = static_cast<int64>(data);
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_long) && details::skip_primes(from, end, 2);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     const auto data = static_cast<uint64>(v);
@@ -256,6 +321,10 @@ class int128_type {
     h |= static_cast<uint64>(Reader<Prime>::Get(from, end)) << 32;
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_int128) && details::skip_primes(from, end, 4);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, static_cast<uint32>(l & 0xFFFFFFFFULL));
@@ -298,6 +367,10 @@ class int256_type {
     }
     return l.read(from, end) && h.read(from, end);
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_int256) && details::skip_primes(from, end, 8);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     l.write(to);
@@ -341,6 +414,10 @@ class double_type {
     std::memcpy(&v, &nonaliased, sizeof(v));
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_double) && details::skip_primes(from, end, 2);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     auto nonaliased = uint64();
@@ -367,6 +444,89 @@ inline bool operator!=(const double_type &a, const double_type &b) {
   return a.v != b.v;
 }
 
+namespace details {
+
+template <typename Accumulator>
+void write_string(Accumulator &to, const char *data, uint32 size) {
+  Expects(size < 0x1000000);
+
+  if (size == 0) {
+    Writer<Accumulator>::Put(to, size);
+  } else if (size == 1) {
+    Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(data[0])) << 8));
+  } else if (size == 2) {
+    Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(data[0])) << 8) |
+                                     (static_cast<uint32>(static_cast<uchar>(data[1])) << 16));
+  } else if (size < 254) {
+    Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(data[0])) << 8) |
+                                     (static_cast<uint32>(static_cast<uchar>(data[1])) << 16) |
+                                     (static_cast<uint32>(static_cast<uchar>(data[2])) << 24));
+    Writer<Accumulator>::PutBytes(to, data + 3, size - 3);
+  } else {
+    const auto encoded = (size << 8) | 254U;
+    Writer<Accumulator>::Put(to, encoded);
+    Writer<Accumulator>::PutBytes(to, data, size);
+  }
+}
+
+// PutShared(to, bytes) writes the bytes like PutBytes does, including
+// the zero padding to a multiple of 4, but may keep a reference instead.
+template <typename Accumulator, typename = void>
+struct has_put_shared : std::false_type {};
+
+template <typename Accumulator>
+struct has_put_shared<Accumulator, std::void_t<decltype(Writer<Accumulator>::PutShared(
+  std::declval<Accumulator &>(),
+  std::declval<const QByteArray &>()))>> : std::true_type {};
+
+// Long values are passed to writers that can keep a reference to them.
+template <typename Accumulator>
+void write_string(Accumulator &to, const QByteArray &data) {
+  const auto size = uint32(data.size());
+  if constexpr (has_put_shared<Accumulator>::value) {
+    if (size >= 254) {
+      Expects(size < 0x1000000);
+
+      Writer<Accumulator>::Put(to, (size << 8) | 254U);
+      Writer<Accumulator>::PutShared(to, data);
+      return;
+    }
+  }
+  write_string(to, data.constData(), size);
+}
+
+// Objects decoded by tl::stream_reader don't outlive the call, so while
+// one is read lazy fields are decoded right away and nothing is memoized.
+// If the object spans several chunks, string payloads of at least
+// kStreamPayloadMinSize bytes are moved from the chunks straight into
+// their own buffers, in wire order, and the input keeps only the headers.
+inline constexpr auto kStreamPayloadMinSize = uint32(4096);
+
+// The moved payload of a long string or nullptr if it is in the input,
+// false if the payloads don't match the strings.
+[[nodiscard]] bool stream_payload(uint32 length, const QByteArray *&result);
+[[nodiscard]] bool reading_stream();
+
+class stream_read_scope final {
+ public:
+  explicit stream_read_scope(const QVector<QByteArray> *payloads);
+  stream_read_scope(const stream_read_scope &other) = delete;
+  stream_read_scope &operator=(const stream_read_scope &other) = delete;
+  ~stream_read_scope();
+
+  // False if some of the payloads weren't taken by the strings.
+  [[nodiscard]] bool finished() const;
+
+ private:
+  friend bool stream_payload(uint32 length, const QByteArray *&result);
+
+  const QVector<QByteArray> *_payloads = nullptr;
+  stream_read_scope *_previous = nullptr;
+  int _next = 0;
+};
+
+}  // namespace details
+
 class string_type;
 using bytes_type = string_type;
 
@@ -406,6 +566,15 @@ class string_type {
       Reader<Prime>::GetBytes(v.data() + 3, remaining, from, end);
     } else {
       const auto length = (first >> 8);
+      if (uint32(length) >= details::kStreamPayloadMinSize) {
+        auto payload = (const QByteArray *)nullptr;
+        if (!details::stream_payload(length, payload)) {
+          return false;
+        } else if (payload) {
+          v = *payload;
+          return true;
+        }
+      }
       if (!Reader<Prime>::HasBytes(length, from, end)) {
         return false;
       }
@@ -414,28 +583,13 @@ class string_type {
     }
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_string) && details::skip_string(from, end);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
-    Expects(v.size() < 0x1000000);
-
-    const auto size = uint32(v.size());
-    if (size == 0) {
-      Writer<Accumulator>::Put(to, size);
-    } else if (size == 1) {
-      Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(v[0])) << 8));
-    } else if (size == 2) {
-      Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(v[0])) << 8) |
-                                       (static_cast<uint32>(static_cast<uchar>(v[1])) << 16));
-    } else if (size < 254) {
-      Writer<Accumulator>::Put(to, size | (static_cast<uint32>(static_cast<uchar>(v[0])) << 8) |
-                                       (static_cast<uint32>(static_cast<uchar>(v[1])) << 16) |
-                                       (static_cast<uint32>(static_cast<uchar>(v[2])) << 24));
-      Writer<Accumulator>::PutBytes(to, v.data() + 3, size - 3);
-    } else {
-      const auto encoded = (size << 8) | 254U;
-      Writer<Accumulator>::Put(to, encoded);
-      Writer<Accumulator>::PutBytes(to, v.data(), size);
-    }
+    details::write_string(to, v);
   }
 
   QByteArray v;
@@ -511,6 +665,199 @@ inline QByteArray utf8(const string_type &v) {
   return utf8(v.v);
 }
 
+class string_view_type;
+using bytes_view_type = string_view_type;
+
+// Borrows the payload from the buffer it was read from,
+// so that buffer must outlive the view and everything holding it.
+class string_view_type {
+ public:
+  string_view_type() = default;
+
+  uint32 type() const {
+    return id_string;
+  }
+  template <typename Prime>
+  [[nodiscard]] bool read(const Prime *&from, const Prime *end, uint32 cons = id_string) {
+    static_assert(sizeof(uint32) % sizeof(Prime) == 0);
+    static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "string_view_type requires wire byte order in memory.");
+
+    if (!Reader<Prime>::Has(1, from, end) || cons != id_string) {
+      return false;
+    }
+    const auto start = reinterpret_cast<const bytes::type *>(from);
+    const auto first = Reader<Prime>::Get(from, end);
+    const auto last = (first & 0xFFU);
+    if (last > 254) {
+      return false;
+    } else if (last < 254) {
+      const auto remaining = (last > 3) ? (last - 3) : 0U;
+      if (!Reader<Prime>::HasBytes(remaining, from, end)) {
+        return false;
+      }
+      v = bytes::const_span(start + 1, last);
+      from += ((remaining + 3) / sizeof(uint32)) * (sizeof(uint32) / sizeof(Prime));
+    } else {
+      const auto length = (first >> 8);
+      if (uint32(length) >= details::kStreamPayloadMinSize) {
+        auto payload = (const QByteArray *)nullptr;
+        if (!details::stream_payload(length, payload)) {
+          return false;
+        } else if (payload) {
+          v = bytes::make_span(*payload);
+          return true;
+        }
+      }
+      if (!Reader<Prime>::HasBytes(length, from, end)) {
+        return false;
+      }
+      v = bytes::const_span(reinterpret_cast<const bytes::type *>(from), length);
+      from += ((uint64(length) + 3) / sizeof(uint32)) * (sizeof(uint32) / sizeof(Prime));
+    }
+    return true;
+  }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    return (!cons || cons == id_string) && details::skip_string(from, end);
+  }
+  template <typename Accumulator>
+  void write(Accumulator &to) const {
+    details::write_string(to, reinterpret_cast<const char *>(v.data()), uint32(v.size()));
+  }
+
+  bytes::const_span v;
+
+ private:
+  explicit string_view_type(bytes::const_span data) : v(data) {
+  }
+
+  friend string_view_type make_string_view(bytes::const_span v);
+  friend string_view_type make_string_view(const QByteArray &v);
+
+  friend bytes_view_type make_bytes_view(bytes::const_span v);
+  friend bytes_view_type make_bytes_view(const QByteArray &v);
+};
+
+inline string_view_type make_string_view(bytes::const_span v) {
+  return string_view_type(v);
+}
+inline string_view_type make_string_view(const QByteArray &v) {
+  return string_view_type(bytes::const_span(reinterpret_cast<const bytes::type *>(v.constData()), v.size()));
+}
+inline string_view_type make_string_view(const string_type &v) {
+  return make_string_view(v.v);
+}
+inline bytes_view_type make_bytes_view(bytes::const_span v) {
+  return bytes_view_type(v);
+}
+inline bytes_view_type make_bytes_view(const QByteArray &v) {
+  return bytes_view_type(bytes::const_span(reinterpret_cast<const bytes::type *>(v.constData()), v.size()));
+}
+inline bytes_view_type make_bytes_view(const bytes_type &v) {
+  return make_bytes_view(v.v);
+}
+inline bytes_type make_bytes(const bytes_view_type &v) {
+  return make_bytes(v.v);
+}
+
+inline bool operator==(const string_view_type &a, const string_view_type &b) {
+  return std::equal(a.v.begin(), a.v.end(), b.v.begin(), b.v.end());
+}
+inline bool operator!=(const string_view_type &a, const string_view_type &b) {
+  return !(a == b);
+}
+
+inline QString utf16(const string_view_type &v) {
+  return QString::fromUtf8(reinterpret_cast<const char *>(v.v.data()), v.v.size());
+}
+
+inline QByteArray utf8(const string_view_type &v) {
+  return QByteArray(reinterpret_cast<const char *>(v.v.data()), v.v.size());
+}
+
+namespace details {
+
+template <typename T>
+inline constexpr uint32 kFixedPrimes = 0;
+
+template <>
+inline constexpr uint32 kFixedPrimes<int_type> = 1;
+template <>
+inline constexpr uint32 kFixedPrimes<long_type> = 2;
+template <>
+inline constexpr uint32 kFixedPrimes<int64_type> = 2;
+template <>
+inline constexpr uint32 kFixedPrimes<int128_type> = 4;
+template <>
+inline constexpr uint32 kFixedPrimes<int256_type> = 8;
+template <>
+inline constexpr uint32 kFixedPrimes<double_type> = 2;
+
+template <typename T>
+inline constexpr uint32 kMinPrimes = kFixedPrimes<T>;
+
+template <>
+inline constexpr uint32 kMinPrimes<string_type> = 1;
+template <>
+inline constexpr uint32 kMinPrimes<string_view_type> = 1;
+template <typename Flags>
+inline constexpr uint32 kMinPrimes<flags_type<Flags>> = 1;
+
+static_assert(sizeof(int_type) == sizeof(uint32));
+static_assert(sizeof(long_type) == 2 * sizeof(uint32));
+static_assert(sizeof(int64_type) == 2 * sizeof(uint32));
+static_assert(sizeof(int128_type) == 4 * sizeof(uint32));
+static_assert(sizeof(int256_type) == 8 * sizeof(uint32));
+static_assert(sizeof(double_type) == 2 * sizeof(uint32));
+
+// Encoded size of a constructor made of fixed-width fields only, or 0.
+template <typename... Fields>
+inline constexpr uint32 kFixedLayoutPrimes = ((kFixedPrimes<Fields> > 0) && ...)
+  ? (kFixedPrimes<Fields> + ...)
+  : 0;
+
+// Such constructors are checked once and copied as a single block.
+template <typename... Fields>
+inline constexpr bool kFixedLayout = (kFixedLayoutPrimes<Fields...> > 0)
+  && (std::is_trivially_copyable_v<Fields> && ...)
+  && (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+template <typename Prime, typename... Fields>
+[[nodiscard]] bool read_fixed(const Prime *&from, const Prime *end, Fields &...fields) {
+  if constexpr (kFixedLayout<Fields...>) {
+    constexpr auto kPrimes = kFixedLayoutPrimes<Fields...>;
+    if (!Reader<Prime>::Has(kPrimes, from, end)) {
+      return false;
+    }
+    uint32 buffer[kPrimes];
+    Reader<Prime>::GetBytes(buffer, sizeof(buffer), from, end);
+    auto position = buffer;
+    ((std::memcpy(static_cast<void *>(&fields), position, sizeof(Fields)), position += kFixedPrimes<Fields>), ...);
+    return true;
+  } else {
+    return (fields.read(from, end) && ...);
+  }
+}
+
+template <typename Accumulator, typename... Fields>
+void write_fixed(Accumulator &to, const Fields &...fields) {
+  if constexpr (std::is_same_v<Accumulator, LengthCounter> && (kFixedLayoutPrimes<Fields...> > 0)) {
+    to.length += kFixedLayoutPrimes<Fields...> * sizeof(uint32);
+  } else if constexpr (kFixedLayout<Fields...>) {
+    uint32 buffer[kFixedLayoutPrimes<Fields...>];
+    auto position = buffer;
+    ((std::memcpy(position, &fields, sizeof(Fields)), position += kFixedPrimes<Fields>), ...);
+    Writer<Accumulator>::PutBytes(to, buffer, sizeof(buffer));
+  } else {
+    (fields.write(to), ...);
+  }
+}
+
+}  // namespace details
+
+template <typename T>
+void publish(const T &value);
+
 template <typename T>
 class vector_type {
  public:
@@ -524,28 +871,85 @@ class vector_type {
     if (!Reader<Prime>::Has(1, from, end) || cons != id_vector) {
       return false;
     }
-    auto count = Reader<Prime>::Get(from, end);
+    const auto count = static_cast<uint32>(Reader<Prime>::Get(from, end));
 
-    auto vector = QVector<T>(count, T());
-    for (auto &item : vector) {
-      if (!item.read(from, end)) {
+    if constexpr (kBulk) {
+      constexpr auto kPrimes = details::kFixedPrimes<T>;
+      constexpr auto kMaxCount = uint32(0xFFFFFFFFU / (kPrimes * sizeof(uint32)));
+      if (count > kMaxCount || !Reader<Prime>::Has(count * kPrimes, from, end)) {
         return false;
       }
+      auto vector = QVector<T>(count);
+      if (count) {
+        Reader<Prime>::GetBytes(vector.data(), count * kPrimes * sizeof(uint32), from, end);
+      }
+      v = std::move(vector);
+    } else {
+      // Never trust the count further than the input can back it.
+      const auto remaining = static_cast<uint32>((end - from) * sizeof(Prime) / sizeof(uint32));
+      const auto limit = remaining / std::max(details::kMinPrimes<T>, 1U);
+
+      auto vector = QVector<T>();
+      vector.reserve(std::min(count, limit));
+      auto item = T();
+      for (auto i = uint32(0); i != count; ++i) {
+        if (!item.read(from, end)) {
+          return false;
+        }
+        vector.push_back(std::move(item));
+      }
+      v = std::move(vector);
     }
-    v = std::move(vector);
     return true;
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    if ((cons && cons != id_vector) || !Reader<Prime>::Has(1, from, end)) {
+      return false;
+    }
+    const auto count = static_cast<uint32>(Reader<Prime>::Get(from, end));
+
+    if constexpr (details::kFixedPrimes<T> > 0) {
+      constexpr auto kPrimes = details::kFixedPrimes<T>;
+      return (count <= 0xFFFFFFFFU / kPrimes) && details::skip_primes(from, end, count * kPrimes);
+    } else {
+      for (auto i = uint32(0); i != count; ++i) {
+        if (!T::skip(from, end, 0, stats)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, static_cast<int32>(v.size()));
-    for (const auto &item : v) {
-      item.write(to);
+    if constexpr (kBulk) {
+      if (!v.isEmpty()) {
+        Writer<Accumulator>::PutBytes(to, v.constData(), uint32(v.size()) * details::kFixedPrimes<T> * sizeof(uint32));
+      }
+    } else {
+      for (const auto &item : v) {
+        item.write(to);
+      }
+    }
+  }
+
+  // A member, so that boxed vectors are published through it as well.
+  void publish() const {
+    if constexpr (!kBulk) {
+      for (const auto &item : v) {
+        tl::publish(item);
+      }
     }
   }
 
   QVector<T> v;
 
  private:
+  // Dense arrays of bare primitives are copied as a single block.
+  static constexpr bool kBulk = (details::kFixedPrimes<T> > 0) && (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
   explicit vector_type(QVector<T> &&data) : v(std::move(data)) {
   }
 
@@ -581,6 +985,13 @@ inline vector_type<T> make_vector() {
   return vector_type<T>();
 }
 
+namespace details {
+
+template <typename T>
+inline constexpr uint32 kMinPrimes<vector_type<T>> = 1;
+
+}  // namespace details
+
 template <typename T>
 inline bool operator==(const vector_type<T> &a, const vector_type<T> &b) {
   return a.c_vector().v == b.c_vector().v;
@@ -610,6 +1021,40 @@ struct inner_helper {
 
 }  // namespace details
 
+namespace details {
+
+template <typename T, typename = void>
+struct has_publish : std::false_type {};
+
+template <typename T>
+struct has_publish<T, std::void_t<decltype(std::declval<const T &>().publish())>> : std::true_type {};
+
+}  // namespace details
+
+// Trees generated with local reference counting must be published
+// before handles to them are copied or destroyed on several threads
+// at once. Publishing walks the tree once and switches every object
+// in it to atomic counting. Passing a tree to another thread without
+// touching it on the first one afterwards needs no publishing.
+template <typename T>
+void publish(const T &value) {
+  if constexpr (details::has_publish<T>::value) {
+    value.publish();
+  }
+}
+
+// Validates a value of type T and advances past it.
+template <typename T, typename Prime>
+[[nodiscard]] bool skip(const Prime *&from, const Prime *end, skip_stats *stats = nullptr) {
+  const auto start = from;
+  if (!T::skip(from, end, 0, stats)) {
+    return false;
+  } else if (stats) {
+    stats->bytes += uint32((from - start) * sizeof(Prime));
+  }
+  return true;
+}
+
 template <typename T>
 class conditional {
  public:
@@ -15,6 +15,8 @@ namespace tl {
 template <typename Accumulator>
 struct Writer;
 
+struct skip_stats;
+
 template <typename bare>
 class boxed : public bare {
  public:
@@ -38,6 +40,14 @@ class boxed : public bare {
     cons = Reader<Prime>::Get(from, end);
     return bare::read(from, end, cons);
   }
+  template <typename Prime>
+  [[nodiscard]] static bool skip(const Prime *&from, const Prime *end, uint32 cons = 0, skip_stats *stats = nullptr) {
+    if (!Reader<Prime>::Has(1, from, end)) {
+      return false;
+    }
+    cons = Reader<Prime>::Get(from, end);
+    return cons && bare::skip(from, end, cons, stats);
+  }
   template <typename Accumulator>
   void write(Accumulator &to) const {
     Writer<Accumulator>::Put(to, bare::type());
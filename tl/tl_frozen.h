@@ -0,0 +1,408 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/bytes.h"
+#include "tl/tl_basic_types.h"
+#include "tl/tl_boxed.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+#include <array>
+#include <cstring>
+#include <optional>
+
+// Frozen values are laid out in a single block of 32-bit words.
+// Each value takes a slot: fixed-width values and flags are kept
+// in the slot itself, any other value is a record in the block
+// and the slot holds the record offset from the block start.
+// A generated constructor record is its id followed by the slots
+// of its fields, strings are a byte length followed by the bytes,
+// vectors are an item count followed by the item slots.
+
+namespace tl {
+namespace details {
+
+class frozen_writer final {
+ public:
+  explicit frozen_writer(uint32 rootWords) : _words(rootWords) {
+  }
+
+  // Appends a zero filled record and stores its offset in the slot.
+  uint32 allocate(uint32 slot, uint32 words) {
+    const auto result = uint32(_words.size());
+    _words.resize(result + words);
+    _words[slot] = result;
+    return result;
+  }
+  uint32 record(uint32 slot, uint32 id, uint32 words) {
+    const auto result = allocate(slot, 1 + words);
+    _words[result] = id;
+    return result;
+  }
+  void put(uint32 slot, const void *data, uint32 words) {
+    memcpy(_words.data() + slot, data, words * sizeof(uint32));
+  }
+  void putBytes(uint32 slot, const void *data, uint32 size) {
+    const auto result = allocate(slot, 1 + (size + 3) / 4);
+    _words[result] = size;
+    if (size) {
+      memcpy(_words.data() + result + 1, data, size);
+    }
+  }
+
+  [[nodiscard]] QByteArray take() const {
+    return QByteArray(
+      reinterpret_cast<const char *>(_words.constData()),
+      _words.size() * sizeof(uint32));
+  }
+
+ private:
+  QVector<uint32> _words;
+};
+
+// Blocks from outside are checked once before any view is made.
+// tl::freeze() appends each record right after the previous one while
+// walking the value, so the checker expects exactly that order. Records
+// can't overlap or repeat, and every offset and length stays inside.
+class frozen_checker final {
+ public:
+  frozen_checker(const uint32 *base, uint32 size, uint32 rootWords)
+  : _base(base)
+  , _size(size)
+  , _next(rootWords) {
+  }
+
+  // The record referenced from an already checked slot.
+  [[nodiscard]] bool record(uint32 slot, uint32 &result) const {
+    result = _base[slot];
+    return (result == _next) && (result < _size);
+  }
+  [[nodiscard]] bool claim(uint64 words) {
+    if (words > _size - _next) {
+      return false;
+    }
+    _next += uint32(words);
+    return true;
+  }
+  [[nodiscard]] uint32 word(uint32 index) const {
+    return _base[index];
+  }
+  [[nodiscard]] bool finished() const {
+    return (_next == _size);
+  }
+
+ private:
+  const uint32 *_base = nullptr;
+  const uint32 _size = 0;
+  uint32 _next = 0;
+};
+
+// Generated types are viewed through their nested Frozen classes.
+template <typename T, typename = void>
+struct frozen_value {
+  using type = typename T::Frozen;
+  static constexpr uint32 kSlotWords = 1;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    return type(base, base[slot]);
+  }
+  static void put(frozen_writer &to, uint32 slot, const T &value) {
+    value.freeze(to, slot);
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    return type::check(checker, slot);
+  }
+  [[nodiscard]] static T thaw(const type &view) {
+    return view.thaw();
+  }
+};
+
+template <typename T>
+struct frozen_value<T, std::enable_if_t<(kFixedPrimes<T> > 0)>> {
+  using type = T;
+  static constexpr uint32 kSlotWords = kFixedPrimes<T>;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    auto result = T();
+    memcpy(static_cast<void *>(&result), base + slot, kSlotWords * sizeof(uint32));
+    return result;
+  }
+  static void put(frozen_writer &to, uint32 slot, const T &value) {
+    to.put(slot, static_cast<const void *>(&value), kSlotWords);
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    return true;
+  }
+  [[nodiscard]] static T thaw(const type &view) {
+    return view;
+  }
+};
+
+template <typename Flags>
+struct frozen_value<flags_type<Flags>> {
+  using type = flags_type<Flags>;
+  static constexpr uint32 kSlotWords = 1;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    auto result = type();
+    memcpy(static_cast<void *>(&result), base + slot, sizeof(uint32));
+    return result;
+  }
+  static void put(frozen_writer &to, uint32 slot, const type &value) {
+    to.put(slot, static_cast<const void *>(&value), kSlotWords);
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    return true;
+  }
+  [[nodiscard]] static type thaw(const type &view) {
+    return view;
+  }
+};
+
+template <>
+struct frozen_value<string_view_type> {
+  using type = string_view_type;
+  static constexpr uint32 kSlotWords = 1;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    const auto record = base[slot];
+    return record
+      ? make_string_view(bytes::const_span(
+        reinterpret_cast<const bytes::type *>(base + record + 1),
+        base[record]))
+      : make_string_view(bytes::const_span());
+  }
+  static void put(frozen_writer &to, uint32 slot, const string_view_type &value) {
+    to.putBytes(slot, value.v.data(), uint32(value.v.size()));
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    auto record = uint32();
+    return checker.record(slot, record)
+      && checker.claim(1 + (uint64(checker.word(record)) + 3) / 4);
+  }
+  [[nodiscard]] static type thaw(const type &view) {
+    return view;
+  }
+};
+
+template <>
+struct frozen_value<string_type> {
+  using type = string_view_type;
+  static constexpr uint32 kSlotWords = 1;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    return frozen_value<string_view_type>::get(base, slot);
+  }
+  static void put(frozen_writer &to, uint32 slot, const string_type &value) {
+    to.putBytes(slot, value.v.constData(), uint32(value.v.size()));
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    return frozen_value<string_view_type>::check(checker, slot);
+  }
+  [[nodiscard]] static string_type thaw(const type &view) {
+    return make_string(QByteArray(
+      reinterpret_cast<const char *>(view.v.data()),
+      view.v.size()));
+  }
+};
+
+template <typename T>
+struct frozen_value<boxed<T>> {
+  using type = typename frozen_value<T>::type;
+  static constexpr uint32 kSlotWords = frozen_value<T>::kSlotWords;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    return frozen_value<T>::get(base, slot);
+  }
+  static void put(frozen_writer &to, uint32 slot, const boxed<T> &value) {
+    frozen_value<T>::put(to, slot, value);
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    return frozen_value<T>::check(checker, slot);
+  }
+  [[nodiscard]] static boxed<T> thaw(const type &view) {
+    return boxed<T>(frozen_value<T>::thaw(view));
+  }
+};
+
+template <typename... Fields>
+[[nodiscard]] constexpr auto frozen_slots() {
+  constexpr uint32 kWords[] = { frozen_value<Fields>::kSlotWords..., 0 };
+  auto result = std::array<uint32, sizeof...(Fields) + 1>();
+  for (auto i = std::size_t(0); i != sizeof...(Fields); ++i) {
+    result[i + 1] = result[i] + kWords[i];
+  }
+  return result;
+}
+
+}  // namespace details
+
+template <typename T>
+using frozen_t = typename details::frozen_value<T>::type;
+
+template <typename T>
+class frozen_range final {
+ public:
+  class const_iterator final {
+   public:
+    const_iterator(const frozen_range *range, int index)
+    : _range(range)
+    , _index(index) {
+    }
+
+    [[nodiscard]] frozen_t<T> operator*() const {
+      return (*_range)[_index];
+    }
+    const_iterator &operator++() {
+      ++_index;
+      return *this;
+    }
+    [[nodiscard]] bool operator==(const const_iterator &other) const {
+      return (_index == other._index);
+    }
+    [[nodiscard]] bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    const frozen_range *_range = nullptr;
+    int _index = 0;
+  };
+
+  frozen_range() = default;
+  frozen_range(const uint32 *base, uint32 record)
+  : _base(base)
+  , _record(record) {
+  }
+
+  [[nodiscard]] int size() const {
+    return _record ? int(_base[_record]) : 0;
+  }
+  [[nodiscard]] bool isEmpty() const {
+    return !size();
+  }
+  [[nodiscard]] frozen_t<T> operator[](int index) const {
+    Expects(index >= 0 && index < size());
+
+    constexpr auto kSlotWords = details::frozen_value<T>::kSlotWords;
+    return details::frozen_value<T>::get(
+      _base,
+      _record + 1 + uint32(index) * kSlotWords);
+  }
+  [[nodiscard]] const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+  [[nodiscard]] const_iterator end() const {
+    return const_iterator(this, size());
+  }
+
+ private:
+  const uint32 *_base = nullptr;
+  uint32 _record = 0;
+};
+
+// Mirrors vector_type, with v being a range instead of a QVector.
+template <typename T>
+class frozen_vector final {
+ public:
+  frozen_vector() = default;
+  frozen_vector(const uint32 *base, uint32 record) : v(base, record) {
+  }
+
+  frozen_range<T> v;
+};
+
+namespace details {
+
+template <typename T>
+struct frozen_value<vector_type<T>> {
+  using type = frozen_vector<T>;
+  static constexpr uint32 kSlotWords = 1;
+
+  [[nodiscard]] static type get(const uint32 *base, uint32 slot) {
+    return type(base, base[slot]);
+  }
+  static void put(frozen_writer &to, uint32 slot, const vector_type<T> &value) {
+    constexpr auto kItemWords = frozen_value<T>::kSlotWords;
+    const auto count = uint32(value.v.size());
+    const auto record = to.allocate(slot, 1 + count * kItemWords);
+    to.put(record, &count, 1);
+    for (auto i = uint32(0); i != count; ++i) {
+      frozen_value<T>::put(to, record + 1 + i * kItemWords, value.v[i]);
+    }
+  }
+  [[nodiscard]] static bool check(frozen_checker &checker, uint32 slot) {
+    constexpr auto kItemWords = frozen_value<T>::kSlotWords;
+    auto record = uint32();
+    if (!checker.record(slot, record)) {
+      return false;
+    }
+    const auto count = checker.word(record);
+    if (!checker.claim(1 + uint64(count) * kItemWords)) {
+      return false;
+    }
+    for (auto i = uint32(0); i != count; ++i) {
+      if (!frozen_value<T>::check(checker, record + 1 + i * kItemWords)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  [[nodiscard]] static vector_type<T> thaw(const type &view) {
+    auto result = QVector<T>();
+    result.reserve(view.v.size());
+    for (const auto &item : view.v) {
+      result.push_back(frozen_value<T>::thaw(item));
+    }
+    return make_vector(std::move(result));
+  }
+};
+
+}  // namespace details
+
+// Lays the value out as a single relocatable block, see above.
+// The words are in host byte order.
+template <typename T>
+[[nodiscard]] QByteArray freeze(const T &value) {
+  auto to = details::frozen_writer(details::frozen_value<T>::kSlotWords);
+  details::frozen_value<T>::put(to, 0, value);
+  return to.take();
+}
+
+// Reads a block made by tl::freeze<T>() in place, without parsing.
+// The layout is checked once in a single pass, so a truncated or corrupt
+// block gives std::nullopt. The block must be aligned to 4 bytes, must
+// outlive the view and must not change while it is viewed.
+template <typename T>
+[[nodiscard]] std::optional<frozen_t<T>> frozen_view(bytes::const_span block) {
+  using value = details::frozen_value<T>;
+  const auto base = reinterpret_cast<const uint32 *>(block.data());
+  const auto size = block.size() / sizeof(uint32);
+  if ((reinterpret_cast<std::uintptr_t>(base) % alignof(uint32))
+    || (block.size() % sizeof(uint32))
+    || (size < value::kSlotWords)
+    || (size > std::size_t(0xFFFFFFFFU))) {
+    return std::nullopt;
+  }
+  auto checker = details::frozen_checker(base, uint32(size), value::kSlotWords);
+  if (!value::check(checker, 0) || !checker.finished()) {
+    return std::nullopt;
+  }
+  return value::get(base, 0);
+}
+
+template <typename T>
+[[nodiscard]] std::optional<T> thaw(bytes::const_span block) {
+  if (const auto view = frozen_view<T>(block)) {
+    return details::frozen_value<T>::thaw(*view);
+  }
+  return std::nullopt;
+}
+
+}  // namespace tl
@@ -0,0 +1,99 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/algorithm.h"
+#include "tl/tl_basic_types.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+namespace tl {
+
+inline constexpr auto kGatherMinShared = uint32(4096);
+
+// Collects the encoding as a list of blocks ready for writev() or sendmsg().
+// Small fields are packed into owned blocks, while byte payloads of at
+// least minShared bytes are referenced and their padding starts the next
+// block, so large payloads are never copied. Generated types write to it
+// when the scheme lists ::tl::gather_buffer in its accumulators.
+class gather_buffer final {
+ public:
+  explicit gather_buffer(uint32 minShared = kGatherMinShared)
+  : _minShared(minShared) {
+  }
+
+  void put(uint32 value) {
+    _current.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+  void putBytes(const void *data, uint32 size) {
+    _current.append(static_cast<const char *>(data), int(size));
+    pad(size);
+  }
+  void putShared(const QByteArray &data) {
+    const auto size = uint32(data.size());
+    if (size < _minShared) {
+      putBytes(data.constData(), size);
+      return;
+    }
+    flush();
+    _blocks.push_back(data);
+    _shared += size;
+    pad(size);
+  }
+
+  // Bytes of the payloads that are referenced instead of copied.
+  [[nodiscard]] uint64 shared() const {
+    return _shared;
+  }
+
+  [[nodiscard]] QVector<QByteArray> take() {
+    flush();
+    _shared = 0;
+    return base::take(_blocks);
+  }
+
+ private:
+  void pad(uint32 size) {
+    static constexpr char kZeros[sizeof(uint32)] = { 0 };
+    if (const auto tail = size % sizeof(uint32)) {
+      _current.append(kZeros, int(sizeof(uint32) - tail));
+    }
+  }
+  void flush() {
+    if (!_current.isEmpty()) {
+      _blocks.push_back(base::take(_current));
+    }
+  }
+
+  QVector<QByteArray> _blocks;
+  QByteArray _current;
+  uint64 _shared = 0;
+  uint32 _minShared = 0;
+};
+
+template <>
+struct Writer<gather_buffer> final {
+  static void PutBytes(gather_buffer &to, const void *bytes, uint32 count) {
+    to.putBytes(bytes, count);
+  }
+  static void Put(gather_buffer &to, uint32 value) {
+    to.put(value);
+  }
+  static void PutShared(gather_buffer &to, const QByteArray &bytes) {
+    to.putShared(bytes);
+  }
+};
+
+template <typename T>
+[[nodiscard]] QVector<QByteArray> gather(const T &value, uint32 minShared = kGatherMinShared) {
+  auto buffer = gather_buffer(minShared);
+  value.write(buffer);
+  return buffer.take();
+}
+
+}  // namespace tl
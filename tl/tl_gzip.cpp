@@ -0,0 +1,160 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_gzip.h"
+
+#include <zlib.h>
+
+namespace tl::details {
+
+inflate_state::inflate_state(uint32 maxSize)
+: _stream(std::make_unique<z_stream_s>())
+, _maxSize(maxSize) {
+  // Accepts both gzip and zlib headers.
+  const auto result = inflateInit2(_stream.get(), 32 + MAX_WBITS);
+  Ensures(result == Z_OK);
+}
+
+inflate_state::~inflate_state() {
+  inflateEnd(_stream.get());
+}
+
+bool inflate_state::push(bytes::const_span data, QVector<QByteArray> &chunks) {
+  if (_failed) {
+    return false;
+  } else if (_finished) {
+    _failed = !data.empty();
+    return !_failed;
+  }
+  _stream->next_in = reinterpret_cast<Bytef *>(const_cast<bytes::type *>(data.data()));
+  _stream->avail_in = uInt(data.size());
+  do {
+    auto chunk = QByteArray(int(kGzipChunk), Qt::Uninitialized);
+    _stream->next_out = reinterpret_cast<Bytef *>(chunk.data());
+    _stream->avail_out = uInt(chunk.size());
+
+    const auto result = ::inflate(_stream.get(), Z_NO_FLUSH);
+    const auto size = chunk.size() - int(_stream->avail_out);
+    _total += size;
+    if (result == Z_STREAM_END) {
+      _finished = true;
+      _failed = (_stream->avail_in > 0);
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      _failed = true;
+    }
+    if (_failed || _total > _maxSize) {
+      _failed = true;
+      return false;
+    } else if (size > 0) {
+      chunk.resize(size);
+      chunks.push_back(std::move(chunk));
+    }
+  } while (!_finished && (_stream->avail_in > 0 || _stream->avail_out == 0));
+  return true;
+}
+
+bool inflate_state::inflate(bytes::const_span data, QByteArray &result) {
+  Expects(!_finished && !_failed);
+
+  // The gzip trailer holds the inflated size modulo 2^32.
+  auto expected = uint32(0);
+  if (data.size() >= 18
+      && uchar(data[0]) == 0x1FU
+      && uchar(data[1]) == 0x8BU) {
+    memcpy(&expected, data.data() + data.size() - sizeof(expected), sizeof(expected));
+  }
+  // Deflate never compresses better than about 1032:1.
+  const auto possible = (uint64(data.size()) + 1) * 1032;
+  // One byte over the limit tells a too large payload from a full one.
+  const auto limit = uint64(_maxSize) + 1;
+  auto size = std::min({ uint64(std::max(expected, kGzipChunk)), possible, limit });
+  result = QByteArray(int(size), Qt::Uninitialized);
+
+  _stream->next_in = reinterpret_cast<Bytef *>(const_cast<bytes::type *>(data.data()));
+  _stream->avail_in = uInt(data.size());
+  auto filled = uint64(0);
+  while (true) {
+    _stream->next_out = reinterpret_cast<Bytef *>(result.data() + filled);
+    _stream->avail_out = uInt(size - filled);
+
+    const auto status = ::inflate(_stream.get(), Z_NO_FLUSH);
+    filled = size - _stream->avail_out;
+    if (status == Z_STREAM_END) {
+      _finished = true;
+      break;
+    } else if ((status != Z_OK && status != Z_BUF_ERROR)
+        || _stream->avail_out > 0
+        || size == limit) {
+      break;
+    }
+    size = std::min(size * 2, limit);
+    result.resize(int(size));
+  }
+  _failed = !_finished || _stream->avail_in > 0 || filled > _maxSize;
+  result.resize(_failed ? 0 : int(filled));
+  return !_failed;
+}
+
+bool inflate_state::finished() const {
+  return _finished;
+}
+
+deflate_state::deflate_state(int level)
+: _stream(std::make_unique<z_stream_s>()) {
+  const auto result = deflateInit2(
+    _stream.get(),
+    level,
+    Z_DEFLATED,
+    16 + MAX_WBITS,
+    8,
+    Z_DEFAULT_STRATEGY);
+  Ensures(result == Z_OK);
+}
+
+deflate_state::~deflate_state() {
+  deflateEnd(_stream.get());
+}
+
+void deflate_state::update(const uchar *data, uint32 size) {
+  _stream->next_in = const_cast<Bytef *>(data);
+  _stream->avail_in = uInt(size);
+  run(Z_NO_FLUSH);
+}
+
+QByteArray deflate_state::finish() {
+  _stream->avail_in = 0;
+  run(Z_FINISH);
+  _result.resize(_size);
+  _size = 0;
+  return std::move(_result);
+}
+
+void deflate_state::run(int flush) {
+  do {
+    if (_size == _result.size()) {
+      _result.resize(std::max(_result.size() * 2, int(kGzipChunk)));
+    }
+    _stream->next_out = reinterpret_cast<Bytef *>(_result.data() + _size);
+    _stream->avail_out = uInt(_result.size() - _size);
+
+    const auto result = ::deflate(_stream.get(), flush);
+    Ensures(result != Z_STREAM_ERROR);
+
+    _size = _result.size() - int(_stream->avail_out);
+  } while (_stream->avail_out == 0);
+}
+
+QByteArray deflate_packed(const uint32 *primes, uint32 length) {
+  auto deflate = deflate_state();
+  deflate.update(reinterpret_cast<const uchar *>(primes), length);
+  auto result = deflate.finish();
+
+  auto counter = LengthCounter();
+  write_string(counter, result);
+  return (sizeof(uint32) + counter.length < length) ? result : QByteArray();
+}
+
+}  // namespace tl::details
@@ -0,0 +1,209 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/bytes.h"
+#include "tl/tl_basic_types.h"
+#include "tl/tl_hash.h"
+#include "tl/tl_serialize.h"
+#include "tl/tl_stream.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+#include <memory>
+#include <span>
+
+struct z_stream_s;
+
+namespace tl {
+
+inline constexpr auto kGzipPackedId = uint32(0x3072CFA1U);
+inline constexpr auto kGzipMinSize = uint32(1024);
+inline constexpr auto kGzipChunk = uint32(64 * 1024);
+
+namespace details {
+
+class inflate_state final {
+ public:
+  explicit inflate_state(uint32 maxSize);
+  inflate_state(const inflate_state &other) = delete;
+  inflate_state &operator=(const inflate_state &other) = delete;
+  ~inflate_state();
+
+  // Appends the inflated chunks, false if the data is broken or too large.
+  [[nodiscard]] bool push(bytes::const_span data, QVector<QByteArray> &chunks);
+
+  // Inflates the complete data into one buffer, presized from the gzip
+  // trailer, false if the data is broken, truncated or too large.
+  [[nodiscard]] bool inflate(bytes::const_span data, QByteArray &result);
+  [[nodiscard]] bool finished() const;
+
+ private:
+  const std::unique_ptr<z_stream_s> _stream;
+  const uint32 _maxSize = 0;
+  uint64 _total = 0;
+  bool _finished = false;
+  bool _failed = false;
+};
+
+class deflate_state final {
+ public:
+  explicit deflate_state(int level = -1);
+  deflate_state(const deflate_state &other) = delete;
+  deflate_state &operator=(const deflate_state &other) = delete;
+  ~deflate_state();
+
+  void update(const uchar *data, uint32 size);
+  [[nodiscard]] QByteArray finish();
+
+ private:
+  void run(int flush);
+
+  const std::unique_ptr<z_stream_s> _stream;
+  QByteArray _result;
+  int _size = 0;
+};
+
+// Deflates the plain encoding, empty if packing it doesn't save space.
+[[nodiscard]] QByteArray deflate_packed(const uint32 *primes, uint32 length);
+
+}  // namespace details
+
+// Deflates the encoding as it is written, generated types write to it
+// when the scheme lists ::tl::gzip_buffer in its accumulators.
+using gzip_buffer = block_writer<details::deflate_state>;
+
+// Decodes consecutive objects from gzip data arriving in pieces,
+// each piece is inflated into chunks that are scanned right away.
+template <typename T, typename Prime>
+class gzip_reader final {
+ public:
+  explicit gzip_reader(uint32 maxSize = kStreamMaxSize)
+  : _inflate(maxSize)
+  , _reader(maxSize) {
+  }
+
+  [[nodiscard]] bool push(bytes::const_span compressed) {
+    auto chunks = QVector<QByteArray>();
+    if (!_inflate.push(compressed, chunks)) {
+      _failed = true;
+      return false;
+    }
+    for (auto &chunk : chunks) {
+      _reader.push(std::move(chunk));
+    }
+    return true;
+  }
+
+  // False if more data is needed or the data is broken.
+  [[nodiscard]] bool next(T &value) {
+    return !_failed && _reader.next(value);
+  }
+
+  [[nodiscard]] bool finished() const {
+    return _inflate.finished();
+  }
+  [[nodiscard]] bool failed() const {
+    return _failed || _reader.failed();
+  }
+
+ private:
+  details::inflate_state _inflate;
+  stream_reader<T, Prime> _reader;
+  bool _failed = false;
+};
+
+// Reads the object either as it is or wrapped in gzip_packed.
+// The packed payload is inflated into one buffer that must hold exactly
+// the object, which is then read from it. A single object isn't decoded
+// while it is inflated, only gzip_reader decodes consecutive objects
+// as they arrive. Lazy and view fields of the value point into inflated,
+// so it has to be kept while they are used.
+template <typename T, typename Prime>
+[[nodiscard]] bool read_packed(
+    T &value,
+    const Prime *&from,
+    const Prime *end,
+    QByteArray &inflated,
+    uint32 maxSize = kStreamMaxSize) {
+  auto start = from;
+  if (!Reader<Prime>::Has(1, start, end)) {
+    return false;
+  } else if (uint32(Reader<Prime>::Get(start, end)) != kGzipPackedId) {
+    inflated = QByteArray();
+    return value.read(from, end);
+  }
+  auto packed = string_view_type();
+  if (!packed.read(start, end)) {
+    return false;
+  }
+  auto inflate = details::inflate_state(maxSize);
+  if (!inflate.inflate(packed.v, inflated)
+      || (inflated.size() % sizeof(Prime)) != 0) {
+    return false;
+  }
+  auto object = reinterpret_cast<const Prime *>(inflated.constData());
+  const auto objectEnd = object + (inflated.size() / sizeof(Prime));
+  if (!value.read(object, objectEnd) || object != objectEnd) {
+    return false;
+  }
+  from = start;
+  return true;
+}
+
+// Wraps the encoding in gzip_packed when it is at least minSize bytes
+// long and deflating it saves space, otherwise writes it as it is.
+// The plain encoding is serialized once and kept for the fallback.
+template <typename Accumulator, typename T>
+void write_packed(
+    Accumulator &to,
+    const T &value,
+    uint32 minSize = kGzipMinSize) {
+  const auto length = count_length(value);
+  if (length < minSize) {
+    value.write(to);
+    return;
+  }
+  auto plain = QVector<uint32>(length / sizeof(uint32));
+  serialize(value, std::span<uint32>(plain.data(), plain.size()));
+  const auto packed = details::deflate_packed(plain.constData(), length);
+  if (packed.isEmpty()) {
+    Writer<Accumulator>::PutBytes(to, plain.constData(), length);
+  } else {
+    Writer<Accumulator>::Put(to, kGzipPackedId);
+    details::write_string(to, packed);
+  }
+}
+
+template <typename Prime = uint32, typename T>
+[[nodiscard]] QVector<Prime> serialize_packed(
+    const T &value,
+    uint32 minSize = kGzipMinSize) {
+  const auto length = count_length(value);
+  if (length < minSize) {
+    return serialize<Prime>(value);
+  }
+  auto plain = QVector<Prime>(length / sizeof(uint32));
+  const auto primes = reinterpret_cast<uint32 *>(plain.data());
+  serialize(value, std::span<uint32>(primes, plain.size()));
+  const auto packed = details::deflate_packed(primes, length);
+  if (packed.isEmpty()) {
+    return plain;
+  }
+  auto counter = details::LengthCounter();
+  details::write_string(counter, packed);
+  auto result = QVector<Prime>(1 + counter.length / sizeof(uint32));
+  result[0] = Prime(kGzipPackedId);
+  auto accumulator = details::SpanAccumulator{
+    reinterpret_cast<uint32 *>(result.data()) + 1
+  };
+  details::write_string(accumulator, packed);
+  return result;
+}
+
+}  // namespace tl
@@ -0,0 +1,150 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_hash.h"
+
+#include <openssl/evp.h>
+#include <zlib.h>
+
+namespace tl {
+namespace details {
+namespace {
+
+constexpr auto kPrime1 = uint64(0x9E3779B185EBCA87ULL);
+constexpr auto kPrime2 = uint64(0xC2B2AE3D27D4EB4FULL);
+constexpr auto kPrime3 = uint64(0x165667B19E3779F9ULL);
+constexpr auto kPrime4 = uint64(0x85EBCA77C2B2AE63ULL);
+constexpr auto kPrime5 = uint64(0x27D4EB2F165667C5ULL);
+
+[[nodiscard]] uint64 RotateLeft(uint64 value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+[[nodiscard]] uint64 Read64(const uchar *data) {
+  auto result = uint64();
+  memcpy(&result, data, sizeof(result));
+  return result;
+}
+
+[[nodiscard]] uint32 Read32(const uchar *data) {
+  auto result = uint32();
+  memcpy(&result, data, sizeof(result));
+  return result;
+}
+
+[[nodiscard]] uint64 Round(uint64 lane, uint64 input) {
+  return RotateLeft(lane + input * kPrime2, 31) * kPrime1;
+}
+
+[[nodiscard]] uint64 Merge(uint64 hash, uint64 lane) {
+  return (hash ^ Round(0, lane)) * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+xxh64_state::xxh64_state(uint64 seed)
+: _lanes({ { seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1 } })
+, _seed(seed) {
+}
+
+void xxh64_state::stripe(const uchar *data) {
+  for (auto i = 0; i != 4; ++i) {
+    _lanes[i] = Round(_lanes[i], Read64(data + i * sizeof(uint64)));
+  }
+}
+
+void xxh64_state::update(const uchar *data, uint32 size) {
+  _total += size;
+  if (_buffered) {
+    const auto add = std::min(uint32(_stripe.size()) - _buffered, size);
+    memcpy(_stripe.data() + _buffered, data, add);
+    _buffered += add;
+    data += add;
+    size -= add;
+    if (_buffered < _stripe.size()) {
+      return;
+    }
+    stripe(_stripe.data());
+    _buffered = 0;
+  }
+  for (; size >= _stripe.size(); data += _stripe.size(), size -= _stripe.size()) {
+    stripe(data);
+  }
+  if (size) {
+    memcpy(_stripe.data(), data, size);
+    _buffered = size;
+  }
+}
+
+uint64 xxh64_state::finish() const {
+  auto result = uint64();
+  if (_total >= _stripe.size()) {
+    result = RotateLeft(_lanes[0], 1)
+      + RotateLeft(_lanes[1], 7)
+      + RotateLeft(_lanes[2], 12)
+      + RotateLeft(_lanes[3], 18);
+    for (const auto lane : _lanes) {
+      result = Merge(result, lane);
+    }
+  } else {
+    result = _seed + kPrime5;
+  }
+  result += _total;
+
+  auto data = _stripe.data();
+  auto size = _buffered;
+  for (; size >= 8; data += 8, size -= 8) {
+    result = RotateLeft(result ^ Round(0, Read64(data)), 27) * kPrime1 + kPrime4;
+  }
+  if (size >= 4) {
+    result = RotateLeft(result ^ (uint64(Read32(data)) * kPrime1), 23) * kPrime2 + kPrime3;
+    data += 4;
+    size -= 4;
+  }
+  for (; size; ++data, --size) {
+    result = RotateLeft(result ^ (*data * kPrime5), 11) * kPrime1;
+  }
+  result ^= result >> 33;
+  result *= kPrime2;
+  result ^= result >> 29;
+  result *= kPrime3;
+  result ^= result >> 32;
+  return result;
+}
+
+void crc32_state::update(const uchar *data, uint32 size) {
+  _value = uint32(::crc32(_value, data, size));
+}
+
+uint32 crc32_state::finish() const {
+  return _value;
+}
+
+sha256_state::sha256_state()
+: _context(EVP_MD_CTX_new()) {
+  Expects(_context != nullptr);
+
+  const auto initialized = EVP_DigestInit_ex(_context, EVP_sha256(), nullptr);
+  Ensures(initialized == 1);
+}
+
+sha256_state::~sha256_state() {
+  EVP_MD_CTX_free(_context);
+}
+
+void sha256_state::update(const uchar *data, uint32 size) {
+  EVP_DigestUpdate(_context, data, size);
+}
+
+std::array<bytes::type, 32> sha256_state::finish() {
+  auto result = std::array<bytes::type, 32>();
+  auto size = static_cast<unsigned int>(result.size());
+  EVP_DigestFinal_ex(_context, reinterpret_cast<uchar*>(result.data()), &size);
+  return result;
+}
+
+}  // namespace details
+}  // namespace tl
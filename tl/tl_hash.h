@@ -0,0 +1,140 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/bytes.h"
+#include "tl/tl_basic_types.h"
+
+#include <array>
+
+struct evp_md_ctx_st;
+
+namespace tl {
+namespace details {
+
+class xxh64_state final {
+ public:
+  explicit xxh64_state(uint64 seed = 0);
+
+  void update(const uchar *data, uint32 size);
+  [[nodiscard]] uint64 finish() const;
+
+ private:
+  void stripe(const uchar *data);
+
+  std::array<uint64, 4> _lanes = { { 0 } };
+  std::array<uchar, 32> _stripe = { { 0 } };
+  uint64 _seed = 0;
+  uint64 _total = 0;
+  uint32 _buffered = 0;
+};
+
+class crc32_state final {
+ public:
+  void update(const uchar *data, uint32 size);
+  [[nodiscard]] uint32 finish() const;
+
+ private:
+  uint32 _value = 0;
+};
+
+class sha256_state final {
+ public:
+  sha256_state();
+  sha256_state(const sha256_state &other) = delete;
+  sha256_state &operator=(const sha256_state &other) = delete;
+  ~sha256_state();
+
+  void update(const uchar *data, uint32 size);
+  [[nodiscard]] std::array<bytes::type, 32> finish();
+
+ private:
+  evp_md_ctx_st *_context = nullptr;
+};
+
+}  // namespace details
+
+// Feeds the encoding to the state as it is written, without an
+// intermediate buffer. Primes are collected in a small block, so that
+// the state is updated with longer runs, large byte payloads go to the
+// state directly.
+template <typename State>
+class block_writer final {
+ public:
+  template <typename ...Args>
+  explicit block_writer(Args &&...args) : _state(std::forward<Args>(args)...) {
+  }
+
+  void put(uint32 value) {
+    if (_size == kBlock) {
+      flush();
+    }
+    memcpy(_block.data() + _size, &value, sizeof(value));
+    _size += sizeof(value);
+  }
+  void putBytes(const void *data, uint32 size) {
+    const auto bytes = static_cast<const uchar *>(data);
+    const auto full = size - (size % sizeof(uint32));
+    if (full >= kBlock) {
+      flush();
+      _state.update(bytes, full);
+    } else {
+      for (auto i = uint32(0); i != full; i += sizeof(uint32)) {
+        auto value = uint32();
+        memcpy(&value, bytes + i, sizeof(value));
+        put(value);
+      }
+    }
+    if (const auto tail = size - full) {
+      auto value = uint32();
+      memcpy(&value, bytes + full, tail);
+      put(value);
+    }
+  }
+
+  [[nodiscard]] auto finish() {
+    flush();
+    return _state.finish();
+  }
+
+ private:
+  static constexpr auto kBlock = uint32(256);
+
+  void flush() {
+    _state.update(_block.data(), _size);
+    _size = 0;
+  }
+
+  State _state;
+  std::array<uchar, kBlock> _block = { { 0 } };
+  uint32 _size = 0;
+};
+
+using xxh64_hasher = block_writer<details::xxh64_state>;
+using crc32_hasher = block_writer<details::crc32_state>;
+using sha256_hasher = block_writer<details::sha256_state>;
+
+template <typename State>
+struct Writer<block_writer<State>> final {
+  static void PutBytes(block_writer<State> &to, const void *bytes, uint32 count) {
+    to.putBytes(bytes, count);
+  }
+  static void Put(block_writer<State> &to, uint32 value) {
+    to.put(value);
+  }
+};
+
+// Hashes the encoded object, by default with the fast non-cryptographic hash.
+// The scheme lists the hashers it uses in its accumulators.
+template <typename Hasher = xxh64_hasher, typename T>
+[[nodiscard]] auto hash_of(const T &value) {
+  auto hasher = Hasher();
+  value.write(hasher);
+  return hasher.finish();
+}
+
+}  // namespace tl
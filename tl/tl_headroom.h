@@ -0,0 +1,121 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+#include "tl/tl_serialize.h"
+
+#include <QtCore/QVector>
+
+#include <span>
+
+namespace tl {
+
+// Keeps free primes in front of the written data, so that outer layers
+// prepend their headers in place after the body is serialized.
+// Generated types write to it when the scheme lists ::tl::headroom_buffer
+// in its accumulators.
+class headroom_buffer final {
+ public:
+  explicit headroom_buffer(uint32 headroom, uint32 capacity = 0)
+  : _begin(headroom) {
+    _data.reserve(int(headroom + capacity));
+    _data.resize(int(headroom));
+  }
+
+  void put(uint32 value) {
+    _data.push_back(value);
+  }
+  void putBytes(const void *data, uint32 size) {
+    if (!size) {
+      return;
+    }
+    const auto was = _data.size();
+    _data.resize(was + int((size + 3) / sizeof(uint32)));
+    if (size % sizeof(uint32)) {
+      _data.back() = 0;
+    }
+    memcpy(_data.data() + was, data, size);
+  }
+
+  void prepend(uint32 value) {
+    *room(1) = value;
+  }
+  void prependBytes(const void *data, uint32 size) {
+    if (!size) {
+      return;
+    }
+    const auto to = room((size + 3) / sizeof(uint32));
+    if (size % sizeof(uint32)) {
+      to[size / sizeof(uint32)] = 0;
+    }
+    memcpy(to, data, size);
+  }
+
+  // Writes the whole object right before the current data.
+  template <typename T>
+  void prependObject(const T &value) {
+    const auto length = count_length(value) / sizeof(uint32);
+    auto accumulator = details::SpanAccumulator{ room(length) };
+    value.write(accumulator);
+  }
+
+  [[nodiscard]] uint32 headroom() const {
+    return _begin;
+  }
+  [[nodiscard]] std::span<const uint32> primes() const {
+    return { _data.constData() + _begin, std::size_t(_data.size()) - _begin };
+  }
+  [[nodiscard]] std::span<uint32> primes() {
+    return { _data.data() + _begin, std::size_t(_data.size()) - _begin };
+  }
+
+ private:
+  [[nodiscard]] uint32 *room(uint32 primes) {
+    if (_begin < primes) {
+      grow(primes - _begin);
+    }
+    _begin -= primes;
+    return _data.data() + _begin;
+  }
+
+  // Headers larger than planned cost a single move of the data.
+  void grow(uint32 primes) {
+    const auto add = std::max(primes, _begin + primes);
+    auto grown = QVector<uint32>(int(add) + _data.size());
+    memcpy(grown.data() + add, _data.constData(), _data.size() * sizeof(uint32));
+    _data = std::move(grown);
+    _begin += add;
+  }
+
+  QVector<uint32> _data;
+  uint32 _begin = 0;
+};
+
+template <>
+struct Writer<headroom_buffer> final {
+  static void PutBytes(headroom_buffer &to, const void *bytes, uint32 count) {
+    to.putBytes(bytes, count);
+  }
+  static void Put(headroom_buffer &to, uint32 value) {
+    to.put(value);
+  }
+};
+
+// Sizes the buffer once, the body is placed right after the headroom
+// and the tailroom is left for the padding appended later.
+template <typename T>
+[[nodiscard]] headroom_buffer serialize_with_headroom(
+    const T &value,
+    uint32 headroom,
+    uint32 tailroom = 0) {
+  auto result = headroom_buffer(headroom, count_length(value) / sizeof(uint32) + tailroom);
+  value.write(result);
+  return result;
+}
+
+}  // namespace tl
@@ -0,0 +1,128 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+
+namespace tl::details {
+
+// A field that is only validated while reading, the value is decoded
+// from the remembered range of the input on first access. Like views
+// it borrows the buffer it was read from, so that buffer must outlive
+// the data object holding the field. Values encoded in fewer than
+// MinBytes bytes or read by tl::stream_reader are decoded right away.
+template <typename T, typename Prime, uint32 MinBytes = 0>
+class lazy final {
+ public:
+  lazy() = default;
+  explicit lazy(T value) : _value(new T(std::move(value))) {
+  }
+  lazy(const lazy &other) = delete;
+  lazy &operator=(const lazy &other) = delete;
+  ~lazy() {
+    delete _value.loadRelaxed();
+  }
+
+  [[nodiscard]] bool read(const Prime *&from, const Prime *end) {
+    if (reading_stream()) {
+      return decode(from, end);
+    }
+    const auto start = from;
+    if (!T::skip(from, end)) {
+      return false;
+    } else if ((from - start) * sizeof(Prime) < MinBytes) {
+      from = start;
+      return decode(from, end);
+    }
+    reset();
+    _from = start;
+    _till = from;
+    return true;
+  }
+
+  // The range can be remembered only in the primes of the field type,
+  // values read from other buffers are decoded right away.
+  template <typename Other>
+  [[nodiscard]] bool read(const Other *&from, const Other *end) {
+    return decode(from, end);
+  }
+
+  // A value that wasn't changed since it was read is written as the same
+  // range, without decoding it.
+  template <typename Accumulator>
+  void write(Accumulator &to) const {
+    if (_from) {
+      Writer<Accumulator>::PutBytes(to, _from, uint32((_till - _from) * sizeof(Prime)));
+    } else {
+      get().write(to);
+    }
+  }
+
+  // If the remembered range passed skip() but can't be read, an empty
+  // value is returned, failed() reports that and write() keeps the range.
+  [[nodiscard]] const T &get() const {
+    if (const auto value = _value.loadAcquire()) {
+      return *value;
+    }
+    auto created = new T();
+    if (_from) {
+      auto from = _from;
+      if (!created->read(from, _till) || from != _till) {
+        delete created;
+        created = new T();
+        _failed.storeRelaxed(1);
+      } else {
+        // The holder may already be shared between threads.
+        tl::publish(*created);
+      }
+    }
+    if (!_value.testAndSetOrdered(nullptr, created)) {
+      delete created;
+      return *_value.loadAcquire();
+    }
+    return *created;
+  }
+
+  [[nodiscard]] bool failed() const {
+    (void)get();
+    return _failed.loadRelaxed() != 0;
+  }
+
+  void publish() const {
+    if (const auto value = _value.loadAcquire()) {
+      tl::publish(*value);
+    }
+  }
+
+ private:
+  template <typename Other>
+  [[nodiscard]] bool decode(const Other *&from, const Other *end) {
+    auto value = T();
+    if (!value.read(from, end)) {
+      return false;
+    }
+    reset();
+    _value.storeRelaxed(new T(std::move(value)));
+    return true;
+  }
+  void reset() {
+    delete _value.loadRelaxed();
+    _value.storeRelaxed(nullptr);
+    _failed.storeRelaxed(0);
+    _from = _till = nullptr;
+  }
+
+  const Prime *_from = nullptr;
+  const Prime *_till = nullptr;
+  mutable QAtomicPointer<T> _value;
+  mutable QAtomicInt _failed = 0;
+};
+
+}  // namespace tl::details
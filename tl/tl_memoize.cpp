@@ -0,0 +1,36 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_memoize.h"
+
+namespace tl {
+namespace details {
+namespace {
+
+thread_local bool MemoizingReads = false;
+
+}  // namespace
+
+memoizing_read::memoizing_read()
+: _active(MemoizingReads && !reading_stream()) {
+  MemoizingReads = false;
+}
+
+memoizing_read::~memoizing_read() {
+  MemoizingReads = _active;
+}
+
+}  // namespace details
+
+memoize_scope::memoize_scope() : _previous(details::MemoizingReads) {
+  details::MemoizingReads = true;
+}
+
+memoize_scope::~memoize_scope() {
+  details::MemoizingReads = _previous;
+}
+
+}  // namespace tl
@@ -0,0 +1,103 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_serialize.h"
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QByteArray>
+
+namespace tl {
+namespace details {
+
+// Encoded fields of an immutable data object, shared by all its handles.
+class cached_encoding final {
+ public:
+  cached_encoding() = default;
+  cached_encoding(const cached_encoding &other) = delete;
+  cached_encoding &operator=(const cached_encoding &other) = delete;
+  ~cached_encoding() {
+    delete _bytes.loadRelaxed();
+  }
+
+  [[nodiscard]] const QByteArray *get() const {
+    return _bytes.loadAcquire();
+  }
+
+  // The first stored value wins.
+  void set(QByteArray bytes) const {
+    const auto created = new QByteArray(std::move(bytes));
+    if (!_bytes.testAndSetOrdered(nullptr, created)) {
+      delete created;
+    }
+  }
+
+ private:
+  mutable QAtomicPointer<const QByteArray> _bytes;
+};
+
+// Writers that can keep a reference to the block get it without a copy.
+template <typename Accumulator>
+void put_encoded(Accumulator &to, const QByteArray &bytes) {
+  if constexpr (has_put_shared<Accumulator>::value) {
+    Writer<Accumulator>::PutShared(to, bytes);
+  } else {
+    Writer<Accumulator>::PutBytes(to, bytes.constData(), uint32(bytes.size()));
+  }
+}
+
+template <typename T>
+void memoize(const T &value, const cached_encoding &encoding) {
+  if (encoding.get()) {
+    return;
+  }
+  auto bytes = QByteArray(count_length(value), Qt::Uninitialized);
+  const auto primes = reinterpret_cast<uint32 *>(bytes.data());
+  serialize(value, std::span<uint32>(primes, bytes.size() / sizeof(uint32)));
+  encoding.set(std::move(bytes));
+}
+
+// Only the outermost memoized object being read keeps its wire bytes,
+// the nested ones are already inside its block, so they aren't copied again.
+class memoizing_read final {
+ public:
+  memoizing_read();
+  memoizing_read(const memoizing_read &other) = delete;
+  memoizing_read &operator=(const memoizing_read &other) = delete;
+  ~memoizing_read();
+
+  [[nodiscard]] bool active() const {
+    return _active;
+  }
+
+ private:
+  bool _active = false;
+};
+
+}  // namespace details
+
+// Keeps the encoded form of the object, so that later writes
+// copy it as a single block instead of walking the tree again.
+template <typename T>
+void memoize(const T &value) {
+  value.memoize();
+}
+
+// While alive, the outermost data objects read on this thread keep their
+// wire bytes, so that forwarding them unchanged never encodes them again.
+class memoize_scope final {
+ public:
+  memoize_scope();
+  memoize_scope(const memoize_scope &other) = delete;
+  memoize_scope &operator=(const memoize_scope &other) = delete;
+  ~memoize_scope();
+
+ private:
+  bool _previous = false;
+};
+
+}  // namespace tl
@@ -0,0 +1,49 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+
+namespace tl {
+
+// One step of a path into an encoded object: the constructor id expected
+// at the current position and a generated seek_* method of its data.
+// Id is zero when the value at the position is bare.
+template <uint32 Id, auto Seek>
+struct at {
+};
+
+namespace details {
+
+template <typename Prime, uint32 Id, auto Seek>
+[[nodiscard]] bool peek_step(const Prime *&from, const Prime *end, at<Id, Seek>) {
+  if constexpr (Id != 0) {
+    if (!Reader<Prime>::Has(1, from, end)
+      || static_cast<uint32>(Reader<Prime>::Get(from, end)) != Id) {
+      return false;
+    }
+  }
+  return Seek(from, end);
+}
+
+}  // namespace details
+
+// Moves from to the field at the path, skipping over everything before it.
+// Fails if a constructor doesn't match or a conditional field is absent.
+template <typename... Steps, typename Prime>
+[[nodiscard]] bool seek(const Prime *&from, const Prime *end) {
+  return (details::peek_step(from, end, Steps()) && ...);
+}
+
+// Reads only the field at the path, for example:
+// tl::peek<tl::at<mtpc_message, &MTPDmessage::seek_date>>(from, end, date);
+template <typename... Steps, typename Prime, typename T>
+[[nodiscard]] bool peek(const Prime *from, const Prime *end, T &result) {
+  return seek<Steps...>(from, end) && result.read(from, end);
+}
+
+}  // namespace tl
@@ -0,0 +1,258 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_pool.h"
+
+#include "base/algorithm.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+
+#include <new>
+
+namespace tl {
+namespace details {
+namespace {
+
+constexpr auto kHeaderSize = std::size_t(16);
+constexpr auto kRemoteBatch = 32;
+constexpr auto kAliveReferences = int(1 << 30);
+
+class pool_data;
+
+struct block_header {
+  pool_data *owner = nullptr;
+  uint32 sizeClass = 0;
+};
+static_assert(sizeof(block_header) <= kHeaderSize);
+
+struct free_block {
+  free_block *next = nullptr;
+};
+
+[[nodiscard]] block_header *HeaderOf(void *object) {
+  return reinterpret_cast<block_header *>(static_cast<char *>(object) - kHeaderSize);
+}
+
+[[nodiscard]] std::size_t ClassSize(uint32 sizeClass) {
+  return (sizeClass + 1) * kPoolGranularity;
+}
+
+[[nodiscard]] void *AllocateBlock(pool_data *owner, uint32 sizeClass) {
+  const auto memory = static_cast<char *>(::operator new(kHeaderSize + ClassSize(sizeClass)));
+  new (memory) block_header{owner, sizeClass};
+  return memory + kHeaderSize;
+}
+
+void FreeBlock(void *object) {
+  ::operator delete(HeaderOf(object));
+}
+
+// Replaces the remote list head once the owner thread is gone.
+[[nodiscard]] free_block *ClosedMarker() {
+  static auto result = free_block();
+  return &result;
+}
+
+class pool_data final {
+ public:
+  [[nodiscard]] void *allocate(std::size_t size);
+  void freeLocal(void *object);
+
+  // Returns false if the owner thread is already gone.
+  [[nodiscard]] bool returnRemote(free_block *first, free_block *last, int count);
+  void releaseReferences(int count);
+  void close();
+
+  [[nodiscard]] pool_statistics statistics() const;
+
+ private:
+  void drainRemote();
+
+  free_block *_free[kPoolSizeClasses] = {};
+  std::size_t _cached[kPoolSizeClasses] = {};
+  std::size_t _used[kPoolSizeClasses] = {};
+
+  // Blocks allocated minus blocks freed on the owner thread.
+  // Blocks returned by other threads are subtracted from _references,
+  // which the owner thread corrects by this value when it exits.
+  int _unaccounted = 0;
+
+  QAtomicPointer<free_block> _remote;
+  QAtomicInt _references = kAliveReferences;
+};
+
+struct remote_batch {
+  pool_data *owner = nullptr;
+  free_block *first = nullptr;
+  free_block *last = nullptr;
+  int count = 0;
+};
+
+thread_local pool_data *LocalPool = nullptr;
+thread_local remote_batch Outgoing;
+thread_local bool Exiting = false;
+
+void FlushOutgoing() {
+  if (!Outgoing.count) {
+    return;
+  }
+  const auto batch = std::exchange(Outgoing, remote_batch());
+  if (!batch.owner->returnRemote(batch.first, batch.last, batch.count)) {
+    auto block = batch.first;
+    for (auto i = 0; i != batch.count; ++i) {
+      const auto next = block->next;
+      FreeBlock(block);
+      block = next;
+    }
+    batch.owner->releaseReferences(batch.count);
+  }
+}
+
+struct thread_guard {
+  ~thread_guard() {
+    Exiting = true;
+    FlushOutgoing();
+    if (LocalPool) {
+      base::take(LocalPool)->close();
+    }
+  }
+};
+
+thread_local thread_guard Guard;
+
+void *pool_data::allocate(std::size_t size) {
+  Expects(size > 0 && size <= kPoolMaxSize);
+
+  const auto sizeClass = uint32((size - 1) / kPoolGranularity);
+  if (!_free[sizeClass]) {
+    drainRemote();
+  }
+  auto result = (void *)nullptr;
+  if (const auto block = _free[sizeClass]) {
+    _free[sizeClass] = block->next;
+    --_cached[sizeClass];
+    block->~free_block();
+    result = block;
+  } else {
+    result = AllocateBlock(this, sizeClass);
+  }
+  ++_used[sizeClass];
+  ++_unaccounted;
+  return result;
+}
+
+void pool_data::freeLocal(void *object) {
+  const auto sizeClass = HeaderOf(object)->sizeClass;
+  _free[sizeClass] = new (object) free_block{_free[sizeClass]};
+  ++_cached[sizeClass];
+  --_used[sizeClass];
+  --_unaccounted;
+}
+
+void pool_data::drainRemote() {
+  auto block = _remote.fetchAndStoreAcquire(nullptr);
+  while (block) {
+    const auto next = block->next;
+    const auto sizeClass = HeaderOf(block)->sizeClass;
+    block->next = _free[sizeClass];
+    _free[sizeClass] = block;
+    ++_cached[sizeClass];
+    --_used[sizeClass];
+    block = next;
+  }
+}
+
+bool pool_data::returnRemote(free_block *first, free_block *last, int count) {
+  auto head = _remote.loadAcquire();
+  do {
+    if (head == ClosedMarker()) {
+      return false;
+    }
+    last->next = head;
+  } while (!_remote.testAndSetRelease(head, first, head));
+  releaseReferences(count);
+  return true;
+}
+
+void pool_data::releaseReferences(int count) {
+  if (_references.fetchAndAddOrdered(-count) == count) {
+    delete this;
+  }
+}
+
+void pool_data::close() {
+  auto block = _remote.fetchAndStoreAcquire(ClosedMarker());
+  while (block) {
+    const auto next = block->next;
+    FreeBlock(block);
+    block = next;
+  }
+  for (auto &list : _free) {
+    while (list) {
+      const auto next = list->next;
+      FreeBlock(list);
+      list = next;
+    }
+  }
+  releaseReferences(kAliveReferences - _unaccounted);
+}
+
+pool_statistics pool_data::statistics() const {
+  auto result = pool_statistics();
+  for (auto i = uint32(0); i != kPoolSizeClasses; ++i) {
+    result.usedBlocks += _used[i];
+    result.usedBytes += _used[i] * ClassSize(i);
+    result.cachedBlocks += _cached[i];
+    result.cachedBytes += _cached[i] * ClassSize(i);
+  }
+  return result;
+}
+
+}  // namespace
+
+void *pool_allocate(std::size_t size) {
+  if (Exiting) {
+    return AllocateBlock(nullptr, uint32((size - 1) / kPoolGranularity));
+  }
+  static_cast<void>(&Guard);
+  if (!LocalPool) {
+    LocalPool = new pool_data();
+  }
+  return LocalPool->allocate(size);
+}
+
+void pool_free(void *object) {
+  const auto owner = HeaderOf(object)->owner;
+  if (!owner) {
+    FreeBlock(object);
+    return;
+  } else if (owner == LocalPool) {
+    owner->freeLocal(object);
+    return;
+  }
+  static_cast<void>(&Guard);
+  if (Outgoing.owner != owner) {
+    FlushOutgoing();
+    Outgoing.owner = owner;
+  }
+  const auto block = new (object) free_block{Outgoing.first};
+  Outgoing.first = block;
+  if (!Outgoing.last) {
+    Outgoing.last = block;
+  }
+  if (++Outgoing.count == kRemoteBatch || Exiting) {
+    FlushOutgoing();
+  }
+}
+
+}  // namespace details
+
+pool_statistics current_pool_statistics() {
+  return details::LocalPool ? details::LocalPool->statistics() : pool_statistics();
+}
+
+}  // namespace tl
@@ -0,0 +1,35 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/basic_types.h"
+
+namespace tl {
+namespace details {
+
+inline constexpr auto kPoolGranularity = std::size_t(16);
+inline constexpr auto kPoolSizeClasses = std::size_t(16);
+inline constexpr auto kPoolMaxSize = kPoolGranularity * kPoolSizeClasses;
+
+// Blocks are cached in free lists of the thread that allocated them.
+// Blocks freed on other threads are returned to it in batches.
+[[nodiscard]] void *pool_allocate(std::size_t size);
+void pool_free(void *object);
+
+}  // namespace details
+
+// Memory held by pooled data objects of the calling thread.
+struct pool_statistics {
+  std::size_t usedBlocks = 0;
+  std::size_t usedBytes = 0;
+  std::size_t cachedBlocks = 0;
+  std::size_t cachedBytes = 0;
+};
+
+[[nodiscard]] pool_statistics current_pool_statistics();
+
+}  // namespace tl
@@ -0,0 +1,236 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_record_log.h"
+
+#include <QtCore/QString>
+
+namespace tl {
+namespace {
+
+constexpr auto kLogMagic = uint32(0x4C524C54); // "TLRL"
+constexpr auto kIndexMagic = uint32(0x49524C54); // "TLRI"
+constexpr auto kVersion = uint32(1);
+
+// The index header keeps the entries aligned for the mapped access.
+constexpr auto kLogHeaderSize = uint64(2 * sizeof(uint32));
+constexpr auto kIndexHeaderSize = uint64(4 * sizeof(uint32));
+constexpr auto kEntrySize = uint64(sizeof(details::record_log_entry));
+
+[[nodiscard]] QString IndexPath(const QString &path) {
+  return path + QStringLiteral(".index");
+}
+
+[[nodiscard]] bool CheckHeader(const uchar *data, uint32 magic) {
+  uint32 header[2] = { 0 };
+  memcpy(header, data, sizeof(header));
+  return (header[0] == magic) && (header[1] == kVersion);
+}
+
+[[nodiscard]] bool ReadHeader(QFile &file, uint32 magic) {
+  uchar header[2 * sizeof(uint32)] = { 0 };
+  return file.seek(0)
+    && (file.read(reinterpret_cast<char *>(header), sizeof(header)) == sizeof(header))
+    && CheckHeader(header, magic);
+}
+
+[[nodiscard]] bool WriteHeader(QFile &file, uint32 magic, uint64 size) {
+  uint32 header[4] = { magic, kVersion, 0, 0 };
+  return file.resize(0)
+    && file.seek(0)
+    && (file.write(reinterpret_cast<const char *>(header), size) == qint64(size));
+}
+
+[[nodiscard]] uint64 FrameEnd(const details::record_log_entry &entry) {
+  return entry.offset + (1 + uint64(entry.length)) * sizeof(uint32);
+}
+
+// Entries come from files, so the offset and the length are checked
+// separately, FrameEnd() of a corrupt entry may overflow.
+[[nodiscard]] bool FrameFits(const details::record_log_entry &entry, uint64 size) {
+  return (entry.offset >= kLogHeaderSize)
+    && (entry.offset <= size)
+    && (entry.length >= 1)
+    && ((size - entry.offset) / sizeof(uint32) >= 1 + uint64(entry.length));
+}
+
+}  // namespace
+
+record_log_writer::record_log_writer(const QString &path)
+: _log(path)
+, _index(IndexPath(path)) {
+  _valid = open();
+}
+
+record_log_writer::~record_log_writer() {
+  flush();
+}
+
+bool record_log_writer::valid() const {
+  return _valid;
+}
+
+uint32 record_log_writer::count() const {
+  return _count;
+}
+
+bool record_log_writer::flush() {
+  return _valid && _log.flush() && _index.flush();
+}
+
+bool record_log_writer::open() {
+  if (!_log.open(QIODevice::ReadWrite) || !_index.open(QIODevice::ReadWrite)) {
+    return false;
+  } else if (!_log.size()) {
+    if (!WriteHeader(_log, kLogMagic, kLogHeaderSize)) {
+      return false;
+    }
+  } else if (!ReadHeader(_log, kLogMagic)) {
+    return false;
+  }
+  if (uint64(_index.size()) < kIndexHeaderSize) {
+    if (!WriteHeader(_index, kIndexMagic, kIndexHeaderSize)) {
+      return false;
+    }
+  } else if (!ReadHeader(_index, kIndexMagic)) {
+    return false;
+  }
+
+  // Drop the index tail pointing past the log, it was written
+  // before the log data reached the disk.
+  const auto logSize = uint64(_log.size());
+  auto count = (uint64(_index.size()) - kIndexHeaderSize) / kEntrySize;
+  auto end = kLogHeaderSize;
+  for (; count > 0; --count) {
+    auto entry = details::record_log_entry();
+    if (!_index.seek(kIndexHeaderSize + (count - 1) * kEntrySize)
+      || _index.read(reinterpret_cast<char *>(&entry), kEntrySize) != qint64(kEntrySize)) {
+      return false;
+    } else if (FrameFits(entry, logSize)) {
+      end = FrameEnd(entry);
+      break;
+    }
+  }
+  if (!_index.resize(kIndexHeaderSize + count * kEntrySize)
+    || !_index.seek(_index.size())) {
+    return false;
+  }
+  _count = uint32(count);
+  return recover(end);
+}
+
+bool record_log_writer::recover(uint64 from) {
+  const auto logSize = uint64(_log.size());
+  _size = from;
+  while (_size + 2 * sizeof(uint32) <= logSize) {
+    uint32 header[2] = { 0 };
+    if (!_log.seek(_size)
+      || _log.read(reinterpret_cast<char *>(header), sizeof(header)) != qint64(sizeof(header))) {
+      return false;
+    }
+    const auto entry = details::record_log_entry{ _size, header[1], header[0] };
+    if (!FrameFits(entry, logSize)) {
+      break;
+    } else if (!appendEntry(entry)) {
+      return false;
+    }
+    _size = FrameEnd(entry);
+  }
+
+  // Cut off the frame torn by a crash.
+  if (_size != logSize && !_log.resize(_size)) {
+    return false;
+  }
+  return _log.seek(_size);
+}
+
+bool record_log_writer::appendEntry(const details::record_log_entry &entry) {
+  if (_index.write(reinterpret_cast<const char *>(&entry), kEntrySize) != qint64(kEntrySize)) {
+    return false;
+  }
+  ++_count;
+  return true;
+}
+
+bool record_log_writer::appendFrame() {
+  if (!_valid) {
+    return false;
+  }
+  const auto bytes = qint64(_frame.size() * sizeof(uint32));
+  const auto entry = details::record_log_entry{ _size, _frame[1], _frame[0] };
+  if (_log.write(reinterpret_cast<const char *>(_frame.constData()), bytes) != bytes
+    || !appendEntry(entry)) {
+    _valid = false;
+    return false;
+  }
+  _size += bytes;
+  return true;
+}
+
+record_log_reader::record_log_reader(const QString &path)
+: _log(path)
+, _index(IndexPath(path)) {
+  if (!_log.open(QIODevice::ReadOnly) || !_index.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  const auto logSize = uint64(_log.size());
+  const auto indexSize = uint64(_index.size());
+  if (logSize < kLogHeaderSize || indexSize < kIndexHeaderSize) {
+    return;
+  }
+  const auto log = _log.map(0, logSize);
+  const auto index = _index.map(0, indexSize);
+  if (!log
+    || !index
+    || !CheckHeader(log, kLogMagic)
+    || !CheckHeader(index, kIndexMagic)) {
+    return;
+  }
+  _data = log;
+  _size = logSize;
+  _entries = reinterpret_cast<const details::record_log_entry *>(index + kIndexHeaderSize);
+  _count = uint32((indexSize - kIndexHeaderSize) / kEntrySize);
+}
+
+bool record_log_reader::valid() const {
+  return (_data != nullptr);
+}
+
+uint32 record_log_reader::count() const {
+  return _count;
+}
+
+uint32 record_log_reader::type(uint32 index) const {
+  Expects(index < _count);
+
+  return _entries[index].type;
+}
+
+QVector<uint32> record_log_reader::find(uint32 type) const {
+  auto result = QVector<uint32>();
+  for (auto i = uint32(0); i != _count; ++i) {
+    if (_entries[i].type == type) {
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+std::span<const uint32> record_log_reader::primes(uint32 index) const {
+  Expects(index < _count);
+
+  const auto &entry = _entries[index];
+  if (!FrameFits(entry, _size) || (entry.offset % sizeof(uint32))) {
+    return {};
+  }
+  const auto frame = reinterpret_cast<const uint32 *>(_data + entry.offset);
+  if (frame[0] != entry.length || frame[1] != entry.type) {
+    return {};
+  }
+  return { frame + 1, entry.length };
+}
+
+}  // namespace tl
@@ -0,0 +1,117 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+#include "tl/tl_boxed.h"
+#include "tl/tl_serialize.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QVector>
+
+#include <span>
+
+// A record log keeps boxed objects one after another, each framed by
+// its length in primes. The sidecar "<path>.index" file has an entry
+// with the offset, constructor id and length of every record, so that
+// records can be reached by number and filtered by type without
+// touching the log itself. Both files are in host byte order.
+
+namespace tl {
+namespace details {
+
+struct record_log_entry {
+  uint64 offset = 0;
+  uint32 type = 0;
+  uint32 length = 0;
+};
+static_assert(sizeof(record_log_entry) == 16);
+
+}  // namespace details
+
+class record_log_writer final {
+ public:
+  // Opens an existing log for appending or creates a new one.
+  // Records lost from the index or torn by a crash are recovered.
+  explicit record_log_writer(const QString &path);
+  record_log_writer(const record_log_writer &other) = delete;
+  record_log_writer &operator=(const record_log_writer &other) = delete;
+  ~record_log_writer();
+
+  [[nodiscard]] bool valid() const;
+  [[nodiscard]] uint32 count() const;
+
+  template <typename T>
+  bool append(const T &value) {
+    static_assert(is_boxed_v<T>, "Records should start with a constructor id.");
+
+    const auto length = uint32(count_length(value) / sizeof(uint32));
+    _frame.resize(1 + length);
+    _frame[0] = length;
+    serialize(value, std::span<uint32>(_frame.data() + 1, length));
+    return appendFrame();
+  }
+  bool flush();
+
+ private:
+  [[nodiscard]] bool open();
+  [[nodiscard]] bool recover(uint64 from);
+  [[nodiscard]] bool appendEntry(const details::record_log_entry &entry);
+  [[nodiscard]] bool appendFrame();
+
+  QFile _log;
+  QFile _index;
+  QVector<uint32> _frame;
+  uint64 _size = 0;
+  uint32 _count = 0;
+  bool _valid = false;
+};
+
+class record_log_reader final {
+ public:
+  // Maps both files, nothing is read or decoded until it is accessed.
+  explicit record_log_reader(const QString &path);
+  record_log_reader(const record_log_reader &other) = delete;
+  record_log_reader &operator=(const record_log_reader &other) = delete;
+
+  [[nodiscard]] bool valid() const;
+  [[nodiscard]] uint32 count() const;
+  [[nodiscard]] uint32 type(uint32 index) const;
+
+  // Numbers of the records with the given constructor id.
+  [[nodiscard]] QVector<uint32> find(uint32 type) const;
+
+  // Primes of the record starting with its constructor id,
+  // empty if the index points outside of the log.
+  template <typename Prime = uint32>
+  [[nodiscard]] std::span<const Prime> record(uint32 index) const {
+    static_assert(sizeof(Prime) == sizeof(uint32));
+
+    const auto words = primes(index);
+    return { reinterpret_cast<const Prime *>(words.data()), words.size() };
+  }
+
+  template <typename Prime, typename T>
+  [[nodiscard]] bool read(uint32 index, T &value) const {
+    const auto words = record<Prime>(index);
+    auto from = words.data();
+    const auto end = from + words.size();
+    return !words.empty() && value.read(from, end) && (from == end);
+  }
+
+ private:
+  [[nodiscard]] std::span<const uint32> primes(uint32 index) const;
+
+  QFile _log;
+  QFile _index;
+  const uchar *_data = nullptr;
+  uint64 _size = 0;
+  const details::record_log_entry *_entries = nullptr;
+  uint32 _count = 0;
+};
+
+}  // namespace tl
@@ -0,0 +1,75 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_ring.h"
+
+namespace tl {
+
+spsc_ring::spsc_ring(uint32 capacity)
+: _data(int(capacity))
+, _capacity(capacity) {
+  Expects(capacity / 2 > 2);
+}
+
+uint32 spsc_ring::maxPrimes() const {
+  return _capacity / 2 - 2;
+}
+
+uint32 *spsc_ring::reserve(uint32 primes) {
+  Expects(primes <= maxPrimes());
+
+  const auto need = 1 + primes;
+  const auto head = _head.loadRelaxed();
+  const auto tail = _tail.loadAcquire();
+
+  // One prime always stays free, so that a full ring differs from an empty one.
+  if (head >= tail) {
+    const auto free = _capacity - head - (tail ? 0 : 1);
+    if (need <= free) {
+      _reserved = head;
+    } else if (need < tail) {
+      _data[head] = kWrap;
+      _reserved = 0;
+    } else {
+      return nullptr;
+    }
+  } else if (need < tail - head) {
+    _reserved = head;
+  } else {
+    return nullptr;
+  }
+  _length = primes;
+  return _data.data() + _reserved + 1;
+}
+
+void spsc_ring::commit() {
+  const auto head = _reserved + 1 + _length;
+  _data[_reserved] = _length;
+  _head.storeRelease((head == _capacity) ? 0 : head);
+}
+
+std::optional<std::span<const uint32>> spsc_ring::peek() {
+  auto tail = _tail.loadRelaxed();
+  const auto head = _head.loadAcquire();
+  if (tail == head) {
+    return std::nullopt;
+  } else if (_data.constData()[tail] == kWrap) {
+    tail = 0;
+    _tail.storeRelease(tail);
+  }
+  return std::span<const uint32>(_data.constData() + tail + 1, _data.constData()[tail]);
+}
+
+void spsc_ring::release() {
+  const auto tail = _tail.loadRelaxed();
+  const auto next = tail + 1 + _data.constData()[tail];
+
+  Expects(tail != _head.loadAcquire());
+
+  _tail.storeRelease((next == _capacity) ? 0 : next);
+}
+
+}  // namespace tl
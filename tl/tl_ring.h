@@ -0,0 +1,72 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+#include "tl/tl_serialize.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QVector>
+
+#include <optional>
+#include <span>
+
+namespace tl {
+
+// A preallocated ring of messages between one producer thread and one
+// consumer thread. Each message is a length prime followed by the body,
+// a message that doesn't fit before the end starts again from the front,
+// so the consumer always gets contiguous bodies.
+class spsc_ring final {
+ public:
+  // The capacity is in primes, messages of up to capacity / 2 - 2 primes
+  // always fit once the consumer catches up, see maxPrimes().
+  explicit spsc_ring(uint32 capacity);
+  spsc_ring(const spsc_ring &other) = delete;
+  spsc_ring &operator=(const spsc_ring &other) = delete;
+
+  [[nodiscard]] uint32 maxPrimes() const;
+
+  // Producer side: room for the body or nullptr if the ring is full,
+  // the body is visible to the consumer after commit().
+  // The body must not be longer than maxPrimes().
+  [[nodiscard]] uint32 *reserve(uint32 primes);
+  void commit();
+
+  // Serializes the object straight into the ring, false if it is full.
+  // The object must not be longer than maxPrimes() primes.
+  template <typename T>
+  bool push(const T &value) {
+    const auto length = count_length(value) / sizeof(uint32);
+    const auto to = reserve(length);
+    if (!to) {
+      return false;
+    }
+    auto accumulator = details::SpanAccumulator{ to };
+    value.write(accumulator);
+    commit();
+    return true;
+  }
+
+  // Consumer side: the next body if there is one, valid until release().
+  [[nodiscard]] std::optional<std::span<const uint32>> peek();
+  void release();
+
+ private:
+  static constexpr auto kWrap = uint32(0xFFFFFFFFU);
+
+  QVector<uint32> _data;
+  const uint32 _capacity = 0;
+
+  alignas(64) QAtomicInteger<uint32> _head = { 0 };
+  uint32 _reserved = 0;
+  uint32 _length = 0;
+
+  alignas(64) QAtomicInteger<uint32> _tail = { 0 };
+};
+
+}  // namespace tl
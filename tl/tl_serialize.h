@@ -0,0 +1,99 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+
+#include <iterator>
+#include <span>
+
+namespace tl {
+namespace details {
+
+// Writes into memory already sized by count_length, without any checks.
+struct SpanAccumulator {
+  uint32 *position = nullptr;
+};
+
+template <typename Iterator>
+struct IteratorAccumulator {
+  Iterator position;
+};
+
+}  // namespace details
+
+template <>
+struct Writer<details::SpanAccumulator> final {
+  static void PutBytes(details::SpanAccumulator &to, const void *bytes, uint32 count) {
+    if (!count) {
+      return;
+    }
+    constexpr auto kPrime = sizeof(uint32);
+    const auto primes = (count / kPrime) + (count % kPrime ? 1 : 0);
+    if (count % kPrime) {
+      to.position[primes - 1] = 0;
+    }
+    std::memcpy(to.position, bytes, count);
+    to.position += primes;
+  }
+  static void Put(details::SpanAccumulator &to, uint32 value) {
+    *to.position++ = value;
+  }
+};
+
+template <typename Iterator>
+struct Writer<details::IteratorAccumulator<Iterator>> final {
+  static void PutBytes(details::IteratorAccumulator<Iterator> &to, const void *bytes, uint32 count) {
+    constexpr auto kPrime = sizeof(uint32);
+    const auto data = static_cast<const char *>(bytes);
+    for (auto offset = uint32(0); offset < count; offset += kPrime) {
+      auto prime = uint32(0);
+      std::memcpy(&prime, data + offset, std::min(uint32(kPrime), count - offset));
+      *to.position++ = prime;
+    }
+  }
+  static void Put(details::IteratorAccumulator<Iterator> &to, uint32 value) {
+    *to.position++ = value;
+  }
+};
+
+// Fills the beginning of a preallocated span, returns the written primes count.
+template <typename T, typename = decltype(std::declval<T>().write(std::declval<details::SpanAccumulator &>()))>
+uint32 serialize(const T &value, std::span<uint32> to) {
+  const auto length = count_length(value) / sizeof(uint32);
+  Expects(length <= to.size());
+
+  auto accumulator = details::SpanAccumulator{to.data()};
+  value.write(accumulator);
+
+  Ensures(accumulator.position == to.data() + length);
+  return length;
+}
+
+// The caller guarantees enough room after the iterator, returns its new position.
+template <typename T, std::output_iterator<uint32> Iterator>
+Iterator serialize(const T &value, Iterator to) {
+  auto accumulator = details::IteratorAccumulator<Iterator>{std::move(to)};
+  value.write(accumulator);
+  return std::move(accumulator.position);
+}
+
+// Sizes the buffer exactly and fills it with a single allocation.
+template <typename Prime = uint32, typename T>
+QVector<Prime> serialize(const T &value) {
+  static_assert(sizeof(Prime) == sizeof(uint32));
+
+  const auto length = count_length(value) / sizeof(uint32);
+  auto result = QVector<Prime>(length);
+  auto accumulator = details::SpanAccumulator{reinterpret_cast<uint32 *>(result.data())};
+  value.write(accumulator);
+
+  Ensures(accumulator.position == reinterpret_cast<uint32 *>(result.data()) + length);
+  return result;
+}
+
+}  // namespace tl
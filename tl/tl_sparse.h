@@ -0,0 +1,142 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/algorithm.h"
+#include "base/basic_types.h"
+#include "tl/tl_arena.h"
+#include "tl/tl_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+
+namespace tl::details {
+
+template <typename Type, int Bit>
+struct sparse_field {
+  using type = Type;
+  static constexpr auto kMask = uint32(1U << Bit);
+};
+
+// Keeps flag-conditional fields of a data object in a single block,
+// only the fields with their bits set in the flags word take space.
+// The block comes from the current arena or the thread pool like the
+// data objects do, and falls back to the heap when it is too large.
+template <typename... Fields>
+class sparse_storage final {
+ public:
+  template <std::size_t Index>
+  using type = typename std::tuple_element_t<Index, std::tuple<Fields...>>::type;
+
+  sparse_storage() = default;
+  sparse_storage(const sparse_storage &other) = delete;
+  sparse_storage &operator=(const sparse_storage &other) = delete;
+  ~sparse_storage() {
+    clear();
+  }
+
+  // Default constructs the fields present in the flags, drops the others.
+  void reset(uint32 flags) {
+    clear();
+    const auto present = (flags & kMask);
+    if (!present) {
+      return;
+    }
+    const auto size = Offset(sizeof...(Fields), present);
+    auto allocation = block_allocation::heap;
+    if (const auto arena = current_arena()) {
+      _block = static_cast<char *>(arena->allocateObject(size, kAlignment));
+      allocation = block_allocation::arena;
+    } else if (size <= kPoolMaxSize && kAlignment <= kPoolGranularity) {
+      _block = static_cast<char *>(pool_allocate(size));
+      allocation = block_allocation::pool;
+    } else {
+      _block = static_cast<char *>(::operator new(size));
+    }
+    new (_block) block_header{ present, allocation };
+    construct(present, std::index_sequence_for<Fields...>());
+  }
+
+  template <std::size_t Index>
+  [[nodiscard]] const type<Index> *get() const {
+    return const_cast<sparse_storage *>(this)->template get<Index>();
+  }
+  template <std::size_t Index>
+  [[nodiscard]] type<Index> *get() {
+    const auto present = this->present();
+    if (!(present & kMasks[Index])) {
+      return nullptr;
+    }
+    return std::launder(reinterpret_cast<type<Index> *>(_block + Offset(Index, present)));
+  }
+
+ private:
+  enum class block_allocation : uint32 {
+    heap,
+    arena,
+    pool,
+  };
+  struct block_header {
+    uint32 present = 0;
+    block_allocation allocation = block_allocation::heap;
+  };
+
+  static constexpr auto kMask = (Fields::kMask | ... | 0U);
+  static constexpr uint32 kMasks[] = {Fields::kMask...};
+  static constexpr auto kAlignment = std::max({alignof(uint32), alignof(typename Fields::type)...});
+  static constexpr std::size_t kSizes[] = {
+    ((sizeof(typename Fields::type) + kAlignment - 1) / kAlignment * kAlignment)...};
+  static constexpr auto kHeaderSize = std::max(sizeof(block_header), kAlignment);
+
+  [[nodiscard]] static std::size_t Offset(std::size_t index, uint32 present) {
+    auto result = kHeaderSize;
+    for (auto i = std::size_t(0); i != index; ++i) {
+      if (present & kMasks[i]) {
+        result += kSizes[i];
+      }
+    }
+    return result;
+  }
+
+  [[nodiscard]] const block_header *header() const {
+    return std::launder(reinterpret_cast<const block_header *>(_block));
+  }
+  [[nodiscard]] uint32 present() const {
+    return _block ? header()->present : 0U;
+  }
+
+  template <std::size_t... Indices>
+  void construct(uint32 present, std::index_sequence<Indices...>) {
+    ((present & kMasks[Indices]
+      ? static_cast<void>(new (_block + Offset(Indices, present)) type<Indices>())
+      : void()), ...);
+  }
+  template <std::size_t... Indices>
+  void destroy(std::index_sequence<Indices...>) {
+    ((get<Indices>() ? std::destroy_at(get<Indices>()) : void()), ...);
+  }
+  void clear() {
+    if (!_block) {
+      return;
+    }
+    destroy(std::index_sequence_for<Fields...>());
+    const auto allocation = header()->allocation;
+    const auto block = base::take(_block);
+    switch (allocation) {
+    case block_allocation::arena: arena_data::Owner(block)->deref(); break;
+    case block_allocation::pool: pool_free(block); break;
+    default: ::operator delete(block); break;
+    }
+  }
+
+  char *_block = nullptr;
+};
+
+}  // namespace tl::details
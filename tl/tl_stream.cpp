@@ -0,0 +1,304 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "tl/tl_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tl::details {
+namespace {
+
+[[nodiscard]] stream_op Op(uint32 code) {
+  return stream_op(code & 0xFFU);
+}
+
+[[nodiscard]] uint32 Argument(uint32 code) {
+  return (code >> 8);
+}
+
+[[nodiscard]] uint32 ItemLength(uint32 code) {
+  switch (Op(code)) {
+  case stream_op::vector:
+  case stream_op::boxed_vector: return 1 + Argument(code);
+  default: return 1;
+  }
+}
+
+}  // namespace
+
+stream_state::stream_state(
+  const stream_scheme &scheme,
+  uint32 type,
+  bool boxed,
+  uint32 maxSize)
+: _scheme(scheme)
+, _entry{ boxed ? stream_boxed(type) : stream_bare(type), stream_end() }
+, _maxSize(maxSize) {
+  restart();
+}
+
+void stream_state::push(QByteArray chunk) {
+  if (!chunk.isEmpty()) {
+    _available += chunk.size();
+    _chunks.push_back(std::move(chunk));
+  }
+}
+
+auto stream_state::scan() -> status {
+  while (!_failed) {
+    if (_pending) {
+      const auto size = std::min(_pending, _available - _scanned);
+      skip(size);
+      _pending -= size;
+      if (_pending) {
+        return status::need_more;
+      }
+    }
+    if (_stack.empty()) {
+      return status::ready;
+    }
+    const auto index = _stack.size() - 1;
+    const auto &frame = _stack[index];
+    if (frame.items && !frame.remaining) {
+      _stack.pop_back();
+      continue;
+    } else if (!(frame.items ? item(index, frame.pc) : step(index))) {
+      return _failed ? status::failed : status::need_more;
+    } else if (_scanned + _pending > _maxSize) {
+      _failed = true;
+    }
+  }
+  return status::failed;
+}
+
+bool stream_state::step(std::size_t index) {
+  auto &frame = _stack[index];
+  const auto pc = frame.pc;
+  const auto code = *pc;
+  switch (Op(code)) {
+  case stream_op::end: {
+    _stack.pop_back();
+  } return true;
+  case stream_op::flags: {
+    auto flags = uint32();
+    if (!read(&flags, sizeof(flags))) {
+      return false;
+    }
+    frame.flags = flags;
+    frame.pc = pc + 1;
+  } return true;
+  case stream_op::conditional: {
+    const auto bit = (Argument(code) & 0x1FU);
+    const auto length = (Argument(code) >> 5);
+    frame.pc = (frame.flags & (1U << bit)) ? (pc + 1) : (pc + 1 + length);
+  } return true;
+  default: return item(index, pc);
+  }
+}
+
+bool stream_state::item(std::size_t index, const uint32 *pc) {
+  const auto code = *pc;
+  const auto done = [&] {
+    auto &frame = _stack[index];
+    if (frame.items) {
+      --frame.remaining;
+    } else {
+      frame.pc = pc + ItemLength(code);
+    }
+  };
+  const auto push = [&](uint32 type, const uint32 *id) {
+    const auto &entry = _scheme.types[type];
+    const auto from = _scheme.constructors + entry.first;
+    const auto till = from + entry.count;
+    const auto found = id
+      ? std::find_if(from, till, [&](const stream_constructor &c) {
+        return (c.id == *id);
+      })
+      : (entry.count == 1) ? from : till;
+    if (found == till) {
+      _failed = true;
+      return false;
+    }
+    done();
+    _stack.push_back({ _scheme.ops + found->program });
+    return true;
+  };
+  switch (Op(code)) {
+  case stream_op::primes: {
+    done();
+    _pending += uint64(Argument(code)) * sizeof(uint32);
+  } return true;
+  case stream_op::string: {
+    auto first = uint32();
+    if (!read(&first, sizeof(first))) {
+      return false;
+    }
+    const auto last = (first & 0xFFU);
+    if (last > 254) {
+      _failed = true;
+      return false;
+    }
+    const auto full = (last == 254)
+      ? (sizeof(uint32) + (first >> 8))
+      : (1 + last);
+    if (last == 254 && (first >> 8) >= kStreamPayloadMinSize) {
+      _payloads.push_back({ _scanned, (first >> 8) });
+    }
+    done();
+    _pending += ((full + 3) & ~uint64(3)) - sizeof(uint32);
+  } return true;
+  case stream_op::boxed: {
+    auto id = uint32();
+    return read(&id, sizeof(id)) && push(Argument(code), &id);
+  }
+  case stream_op::bare: return push(Argument(code), nullptr);
+  case stream_op::vector:
+  case stream_op::boxed_vector: {
+    const auto boxed = (Op(code) == stream_op::boxed_vector);
+    uint32 header[2] = { 0 };
+    if (!read(header, boxed ? 2 * sizeof(uint32) : sizeof(uint32))) {
+      return false;
+    } else if (boxed && header[0] != id_vector) {
+      _failed = true;
+      return false;
+    }
+    const auto count = header[boxed ? 1 : 0];
+    const auto itemCode = pc[1];
+    done();
+    if (Op(itemCode) == stream_op::primes) {
+      _pending += uint64(count) * Argument(itemCode) * sizeof(uint32);
+    } else if (count) {
+      _stack.push_back({ pc + 1, 0, count, true });
+    }
+  } return true;
+  default: break;
+  }
+  _failed = true;
+  return false;
+}
+
+bool stream_state::read(void *to, uint32 size) {
+  if (_available - _scanned < size) {
+    return false;
+  }
+  auto data = static_cast<char *>(to);
+  _scanned += size;
+  while (size) {
+    const auto &chunk = _chunks[_chunk];
+    const auto part = std::min(size, uint32(chunk.size() - _offset));
+    memcpy(data, chunk.constData() + _offset, part);
+    data += part;
+    size -= part;
+    _offset += part;
+    if (_offset == chunk.size()) {
+      ++_chunk;
+      _offset = 0;
+    }
+  }
+  return true;
+}
+
+void stream_state::skip(uint64 size) {
+  _scanned += size;
+  while (size) {
+    const auto &chunk = _chunks[_chunk];
+    const auto part = std::min(size, uint64(chunk.size() - _offset));
+    size -= part;
+    _offset += int(part);
+    if (_offset == chunk.size()) {
+      ++_chunk;
+      _offset = 0;
+    }
+  }
+}
+
+bytes::const_span stream_state::object() {
+  Expects(_stack.empty() && !_pending);
+
+  const auto size = _scanned;
+  if (!size) {
+    return {};
+  }
+  const auto &chunk = _chunks.front();
+  if ((_first % sizeof(uint32)) == 0 && chunk.size() - _first >= size) {
+    return bytes::make_span(chunk).subspan(_first, size);
+  }
+  const auto padded = [](uint32 length) {
+    return (uint64(length) + 3) & ~uint64(3);
+  };
+  auto assembled = size;
+  for (const auto &payload : _payloads) {
+    assembled -= padded(payload.length);
+  }
+  _assembled.resize(int(assembled));
+  _extracted.reserve(int(_payloads.size()));
+  _extracting = true;
+
+  auto chunkIndex = 0;
+  auto chunkOffset = _first;
+  auto to = _assembled.data();
+  auto position = uint64(0);
+  for (const auto &payload : _payloads) {
+    copy(chunkIndex, chunkOffset, to, payload.offset - position);
+    to += payload.offset - position;
+
+    auto data = QByteArray(int(payload.length), Qt::Uninitialized);
+    copy(chunkIndex, chunkOffset, data.data(), payload.length);
+    copy(chunkIndex, chunkOffset, nullptr, padded(payload.length) - payload.length);
+    _extracted.push_back(std::move(data));
+    position = payload.offset + padded(payload.length);
+  }
+  copy(chunkIndex, chunkOffset, to, size - position);
+  return bytes::make_span(_assembled);
+}
+
+const QVector<QByteArray> *stream_state::payloads() const {
+  return _extracting ? &_extracted : nullptr;
+}
+
+void stream_state::copy(int &chunk, int &offset, char *to, uint64 size) const {
+  while (size) {
+    const auto &part = _chunks[chunk];
+    const auto count = std::min(size, uint64(part.size() - offset));
+    if (to) {
+      memcpy(to, part.constData() + offset, count);
+      to += count;
+    }
+    size -= count;
+    offset += int(count);
+    if (offset == part.size()) {
+      ++chunk;
+      offset = 0;
+    }
+  }
+}
+
+void stream_state::consume() {
+  auto size = _scanned;
+  while (!_chunks.empty() && _first + size >= uint64(_chunks.front().size())) {
+    size -= _chunks.front().size() - _first;
+    _first = 0;
+    _chunks.removeFirst();
+  }
+  _first += int(size);
+  _available -= _scanned;
+  restart();
+}
+
+void stream_state::restart() {
+  _chunk = 0;
+  _offset = _first;
+  _scanned = 0;
+  _pending = 0;
+  _payloads.clear();
+  _extracted.clear();
+  _extracting = false;
+  _stack.clear();
+  _stack.push_back({ _entry });
+}
+
+}  // namespace tl::details
@@ -0,0 +1,212 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "base/algorithm.h"
+#include "base/bytes.h"
+#include "tl/tl_basic_types.h"
+#include "tl/tl_boxed.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+#include <vector>
+
+namespace tl {
+namespace details {
+
+// Generated schemes describe the wire layout of each constructor
+// as a program of these ops, which lets the layout be followed
+// with an explicit state over data that arrives in chunks.
+enum class stream_op : uint32 {
+  end,
+  primes,
+  flags,
+  string,
+  boxed,
+  bare,
+  vector,
+  boxed_vector,
+  conditional,
+};
+
+[[nodiscard]] constexpr uint32 stream_code(stream_op op, uint32 argument = 0) {
+  return uint32(op) | (argument << 8);
+}
+[[nodiscard]] constexpr uint32 stream_end() {
+  return stream_code(stream_op::end);
+}
+[[nodiscard]] constexpr uint32 stream_primes(uint32 count) {
+  return stream_code(stream_op::primes, count);
+}
+[[nodiscard]] constexpr uint32 stream_flags() {
+  return stream_code(stream_op::flags);
+}
+[[nodiscard]] constexpr uint32 stream_string() {
+  return stream_code(stream_op::string);
+}
+[[nodiscard]] constexpr uint32 stream_boxed(uint32 type) {
+  return stream_code(stream_op::boxed, type);
+}
+[[nodiscard]] constexpr uint32 stream_bare(uint32 type) {
+  return stream_code(stream_op::bare, type);
+}
+
+// Vector ops are followed by the item, its length is the argument.
+[[nodiscard]] constexpr uint32 stream_vector(uint32 itemLength) {
+  return stream_code(stream_op::vector, itemLength);
+}
+[[nodiscard]] constexpr uint32 stream_boxed_vector(uint32 itemLength) {
+  return stream_code(stream_op::boxed_vector, itemLength);
+}
+
+// Skips the following field unless the bit is set in the flags.
+[[nodiscard]] constexpr uint32 stream_conditional(uint32 bit, uint32 fieldLength) {
+  return stream_code(stream_op::conditional, bit | (fieldLength << 5));
+}
+
+struct stream_constructor {
+  uint32 id = 0;
+  uint32 program = 0;
+};
+
+struct stream_type {
+  uint32 first = 0;
+  uint32 count = 0;
+};
+
+struct stream_scheme {
+  const uint32 *ops = nullptr;
+  const stream_constructor *constructors = nullptr;
+  const stream_type *types = nullptr;
+};
+
+class stream_state final {
+ public:
+  enum class status {
+    need_more,
+    ready,
+    failed,
+  };
+
+  stream_state(
+    const stream_scheme &scheme,
+    uint32 type,
+    bool boxed,
+    uint32 maxSize);
+  stream_state(const stream_state &other) = delete;
+  stream_state &operator=(const stream_state &other) = delete;
+
+  void push(QByteArray chunk);
+
+  // Follows the layout over the data pushed since the last call.
+  [[nodiscard]] status scan();
+
+  // The whole ready object, pointing into a chunk when it fits in one.
+  // Otherwise it is assembled without the long string payloads, which
+  // are copied straight into their own buffers, see stream_read_scope.
+  [[nodiscard]] bytes::const_span object();
+  [[nodiscard]] const QVector<QByteArray> *payloads() const;
+  void consume();
+
+ private:
+  struct frame {
+    const uint32 *pc = nullptr;
+    uint32 flags = 0;
+    uint32 remaining = 0;
+    bool items = false;
+  };
+  struct payload {
+    uint64 offset = 0;
+    uint32 length = 0;
+  };
+
+  [[nodiscard]] bool step(std::size_t index);
+  [[nodiscard]] bool item(std::size_t index, const uint32 *pc);
+  [[nodiscard]] bool read(void *to, uint32 size);
+  void skip(uint64 size);
+  void restart();
+  void copy(int &chunk, int &offset, char *to, uint64 size) const;
+
+  const stream_scheme &_scheme;
+  const uint32 _entry[2] = { 0 };
+  const uint32 _maxSize = 0;
+
+  QVector<QByteArray> _chunks;
+  QByteArray _assembled;
+  QVector<QByteArray> _extracted;
+  std::vector<payload> _payloads;
+  bool _extracting = false;
+  int _first = 0;
+  int _chunk = 0;
+  int _offset = 0;
+
+  uint64 _available = 0;
+  uint64 _scanned = 0;
+  uint64 _pending = 0;
+  std::vector<frame> _stack;
+  bool _failed = false;
+};
+
+}  // namespace details
+
+inline constexpr auto kStreamMaxSize = uint32(64 * 1024 * 1024);
+
+// Decodes consecutive objects of a generated type from data arriving
+// in chunks of any size. Chunks are kept as they are, an object is
+// followed across them as they arrive and is read once it is complete.
+// Only objects spanning several chunks are assembled, long string
+// payloads go from the chunks straight into the strings.
+// Lazy fields are decoded right away, view fields borrow the data
+// until the next call.
+template <typename T, typename Prime>
+class stream_reader final {
+ public:
+  explicit stream_reader(uint32 maxSize = kStreamMaxSize)
+  : _state(T::StreamScheme(), T::kStreamType, is_boxed_v<T>, maxSize) {
+  }
+
+  void push(QByteArray chunk) {
+    _state.push(std::move(chunk));
+  }
+
+  // False if more data is needed or the stream is broken.
+  [[nodiscard]] bool next(T &value) {
+    using status = details::stream_state::status;
+    if (_failed) {
+      return false;
+    } else if (base::take(_consume)) {
+      _state.consume();
+    }
+    const auto scanned = _state.scan();
+    if (scanned != status::ready) {
+      _failed = (scanned == status::failed);
+      return false;
+    }
+    const auto data = _state.object();
+    auto from = reinterpret_cast<const Prime *>(data.data());
+    const auto end = from + data.size() / sizeof(Prime);
+    _consume = true;
+    const auto scope = details::stream_read_scope(_state.payloads());
+    if (!value.read(from, end) || from != end || !scope.finished()) {
+      _failed = true;
+      return false;
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool failed() const {
+    return _failed;
+  }
+
+ private:
+  details::stream_state _state;
+  bool _consume = false;
+  bool _failed = false;
+};
+
+}  // namespace tl
@@ -7,6 +7,10 @@
 #pragma once
 
 #include "base/algorithm.h"
+#include "tl/tl_arena.h"
+#include "tl/tl_pool.h"
+
+#include <new>
 
 namespace tl::details {
 
@@ -22,45 +26,180 @@ class type_data {
   }
 
  private:
+  enum class allocation : uchar {
+    heap,
+    arena,
+    pool,
+    shared,
+  };
+
+  // Local counting uses plain loads and stores until the data is published.
+  template <typename Policy>
   void incrementCounter() const {
-    _counter.ref();
+    if (_allocation == allocation::shared) {
+      return;
+    } else if (Policy::kAtomic || _published) {
+      _counter.ref();
+    } else {
+      _counter.storeRelaxed(_counter.loadRelaxed() + 1);
+    }
   }
+  template <typename Policy>
   bool decrementCounter() const {
-    return _counter.deref();
+    if (_allocation == allocation::shared) {
+      return true;
+    } else if (Policy::kAtomic || _published) {
+      return _counter.deref();
+    }
+    const auto counter = _counter.loadRelaxed() - 1;
+    _counter.storeRelaxed(counter);
+    return (counter != 0);
   }
-  friend class type_owner;
+  template <typename Policy>
+  friend class basic_type_owner;
+
+  template <typename Data, typename... Args>
+  friend Data *create(Args &&...args);
+  friend void destroy(const type_data *data);
+  template <ushort TypeIndex>
+  friend class shared_data;
 
   mutable QAtomicInt _counter = {1};
+  allocation _allocation = allocation::heap;
+  mutable bool _published = false;
+
+  // Constructor index for handles without a type id field, 0 if unused.
+  ushort _typeIndex = 0;
 };
 
-class type_owner {
+// Stands for a constructor without fields in compact handles,
+// it is never counted nor destroyed.
+template <ushort TypeIndex>
+class shared_data final : public type_data {
  public:
-  type_owner(type_owner &&other) : _data(base::take(other._data)) {
+  shared_data() {
+    _allocation = allocation::shared;
+    _published = true;
+    _typeIndex = TypeIndex;
   }
-  type_owner(const type_owner &other) : _data(other._data) {
+};
+
+template <ushort TypeIndex>
+[[nodiscard]] const type_data *shared_type_data() {
+  static const auto result = shared_data<TypeIndex>();
+  return &result;
+}
+
+// Encoded length of an immutable data object, computed on first use.
+class cached_length final {
+ public:
+  template <typename Compute>
+  [[nodiscard]] uint32 get(Compute &&compute) const {
+    if (const auto result = _value.loadRelaxed()) {
+      return result;
+    }
+    const auto result = uint32(compute());
+    _value.storeRelaxed(result);
+    return result;
+  }
+
+ private:
+  mutable QAtomicInteger<uint32> _value = {0};
+};
+
+struct atomic_counting {
+  static constexpr bool kAtomic = true;
+};
+
+// For trees that never leave the thread that created them,
+// see tl::publish() for handing them to other threads.
+struct local_counting {
+  static constexpr bool kAtomic = false;
+};
+
+template <typename Data, typename = void>
+inline constexpr ushort type_index = 0;
+
+template <typename Data>
+inline constexpr ushort type_index<Data, std::void_t<decltype(Data::kTypeIndex)>> = Data::kTypeIndex;
+
+template <typename Data, typename = void>
+inline constexpr bool is_pooled = false;
+
+template <typename Data>
+inline constexpr bool is_pooled<Data, std::void_t<decltype(Data::kPooled)>>
+  = Data::kPooled
+    && (sizeof(Data) <= kPoolMaxSize)
+    && (alignof(Data) <= kPoolGranularity);
+
+// Generated code allocates and frees data objects only through these.
+template <typename Data, typename... Args>
+[[nodiscard]] Data *create(Args &&...args) {
+  const auto result = [&] {
+    if (const auto arena = current_arena()) {
+      const auto memory = arena->allocateObject(sizeof(Data), alignof(Data));
+      const auto result = new (memory) Data(std::forward<Args>(args)...);
+      result->_allocation = type_data::allocation::arena;
+      return result;
+    } else if constexpr (is_pooled<Data>) {
+      const auto memory = pool_allocate(sizeof(Data));
+      const auto result = new (memory) Data(std::forward<Args>(args)...);
+      result->_allocation = type_data::allocation::pool;
+      return result;
+    }
+    return new Data(std::forward<Args>(args)...);
+  }();
+  if constexpr (type_index<Data> != 0) {
+    result->_typeIndex = type_index<Data>;
+  }
+  return result;
+}
+
+inline void destroy(const type_data *data) {
+  switch (data->_allocation) {
+  case type_data::allocation::arena: {
+    const auto arena = arena_data::Owner(data);
+    data->~type_data();
+    arena->deref();
+  } break;
+  case type_data::allocation::pool: {
+    const auto memory = const_cast<type_data *>(data);
+    data->~type_data();
+    pool_free(memory);
+  } break;
+  default: delete data; break;
+  }
+}
+
+template <typename Policy>
+class basic_type_owner {
+ public:
+  basic_type_owner(basic_type_owner &&other) : _data(base::take(other._data)) {
+  }
+  basic_type_owner(const basic_type_owner &other) : _data(other._data) {
     incrementCounter();
   }
-  type_owner &operator=(type_owner &&other) {
+  basic_type_owner &operator=(basic_type_owner &&other) {
     if (other._data != _data) {
       decrementCounter();
       _data = base::take(other._data);
     }
     return *this;
   }
-  type_owner &operator=(const type_owner &other) {
+  basic_type_owner &operator=(const basic_type_owner &other) {
     if (other._data != _data) {
       setData(other._data);
       incrementCounter();
     }
     return *this;
   }
-  ~type_owner() {
+  ~basic_type_owner() {
     decrementCounter();
   }
 
  protected:
-  type_owner() = default;
-  type_owner(const type_data *data) : _data(data) {
+  basic_type_owner() = default;
+  basic_type_owner(const type_data *data) : _data(data) {
   }
 
   void setData(const type_data *data) {
@@ -80,19 +219,35 @@ class type_owner {
     return _data != nullptr;
   }
 
+  ushort dataTypeIndex() const {
+    return _data ? _data->_typeIndex : 0;
+  }
+
+  // Switches the data to atomic counting, false if it already was.
+  bool publishData() const {
+    if (!_data || _data->_published) {
+      return false;
+    }
+    _data->_published = true;
+    return true;
+  }
+
  private:
   void incrementCounter() {
     if (_data) {
-      _data->incrementCounter();
+      _data->template incrementCounter<Policy>();
     }
   }
   void decrementCounter() {
-    if (_data && !_data->decrementCounter()) {
-      delete base::take(_data);
+    if (_data && !_data->template decrementCounter<Policy>()) {
+      destroy(base::take(_data));
     }
   }
 
   const type_data *_data = nullptr;
 };
 
+using type_owner = basic_type_owner<atomic_counting>;
+using local_type_owner = basic_type_owner<local_counting>;
+
 }  // namespace tl::details
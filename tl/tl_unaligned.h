@@ -0,0 +1,106 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "tl/tl_basic_types.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+// Readers and writers over plain byte buffers with any alignment, so that
+// network frames, std::string or mapped files are decoded in place.
+// Primes are kept in host byte order, like in the other buffers.
+// Generated types use them when the scheme lists std::byte in its readers
+// and std::string or std::vector<std::byte> in its accumulators.
+
+namespace tl {
+namespace details {
+
+template <typename Byte>
+struct unaligned_reader {
+  static_assert(sizeof(Byte) == 1);
+
+  [[nodiscard]] static bool Has(uint32 primes, const Byte *from, const Byte *end) {
+    return uint64(end - from) >= uint64(primes) * sizeof(uint32);
+  }
+  [[nodiscard]] static uint32 Get(const Byte *&from, const Byte *end) {
+    Expects(end - from >= int64(sizeof(uint32)));
+
+    auto result = uint32();
+    memcpy(&result, from, sizeof(result));
+    from += sizeof(result);
+    return result;
+  }
+  [[nodiscard]] static bool HasBytes(uint32 bytes, const Byte *from, const Byte *end) {
+    return uint64(end - from) >= Padded(bytes);
+  }
+  static void GetBytes(void *bytes, uint32 count, const Byte *&from, const Byte *end) {
+    Expects(uint64(end - from) >= Padded(count));
+
+    memcpy(bytes, from, count);
+    from += Padded(count);
+  }
+
+ private:
+  [[nodiscard]] static uint64 Padded(uint32 bytes) {
+    return (uint64(bytes) + 3) & ~uint64(3);
+  }
+};
+
+template <typename Container>
+struct byte_writer {
+  using Byte = typename Container::value_type;
+  static_assert(sizeof(Byte) == 1);
+
+  static void PutBytes(Container &to, const void *bytes, uint32 count) {
+    const auto data = static_cast<const Byte *>(bytes);
+    to.insert(to.end(), data, data + count);
+    to.resize(to.size() + (sizeof(uint32) - count % sizeof(uint32)) % sizeof(uint32));
+  }
+  static void Put(Container &to, uint32 value) {
+    const auto data = reinterpret_cast<const Byte *>(&value);
+    to.insert(to.end(), data, data + sizeof(value));
+  }
+};
+
+}  // namespace details
+
+template <>
+struct Reader<std::byte> final : details::unaligned_reader<std::byte> {
+};
+
+template <>
+struct Reader<char> final : details::unaligned_reader<char> {
+};
+
+template <>
+struct Writer<std::string> final : details::byte_writer<std::string> {
+};
+
+template <>
+struct Writer<std::vector<std::byte>> final : details::byte_writer<std::vector<std::byte>> {
+};
+
+// Decodes the whole buffer into the object, without copying it first.
+template <typename T>
+[[nodiscard]] bool deserialize(T &value, std::span<const std::byte> data) {
+  auto from = data.data();
+  const auto end = from + data.size();
+  return value.read(from, end) && (from == end);
+}
+
+template <typename Container = std::vector<std::byte>, typename T>
+[[nodiscard]] Container serialize_bytes(const T &value) {
+  auto result = Container();
+  result.reserve(count_length(value));
+  value.write(result);
+  return result;
+}
+
+}  // namespace tl